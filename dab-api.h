@@ -137,12 +137,124 @@ typedef	struct {
 //	function registered as
 	typedef void (*motdata_t)(std::string, int, void *);
 //	is invoked (if not specified as NULL)
+//	The file is written - and the function called - by a separate
+//	thread of the library, not by the decoder.
+//
+//	Complete MOT objects (slides, but also e.g. EPG objects) can be
+//	handed over in memory, the function registered with
+//	dab_setMotObjectHandler
+	typedef void (*motObject_t)(std::string name,
+	                            int contentType, int contentsubType,
+	                            const uint8_t *data, int32_t length,
+	                            void *);
+//	is called with the name, the type and the body of the object.
+//	The data is only valid during the call.
 //
 //	For Hayati's tii handling:
 //      TII
         typedef void (*tii_t)(int16_t mainId, int16_t subId, unsigned num, void *);
         typedef void (*tii_ex_t)(int numOut, int *outTii, float *outAvgSNR, float *outMinSNR, float *outNxtSNR, unsigned numAvg, const float *Pavg, int Pavg_T_u, void *userData);
 
+//
+//	In "decode all" mode, all services of the ensemble are decoded,
+//	the output is passed on through the callbacks below, the first
+//	parameter of each being the SId of the service
+	typedef void (*serviceAudioOut_t)(int32_t,	// SId
+	                                  int16_t *,	// buffer
+	                                  int,		// size
+	                                  int,		// samplerate
+	                                  bool,		// stereo
+	                                  void *);
+	typedef void (*serviceDataOut_t)(int32_t, std::string, void *);
+	typedef void (*serviceBytesOut_t)(int32_t,
+	                                  uint8_t *, int16_t, uint8_t, void *);
+	typedef void (*serviceQuality_t)(int32_t,
+	                                 int16_t, int16_t, int16_t, void *);
+	typedef void (*serviceMotdata_t)(int32_t, std::string, int, void *);
+
+typedef struct {
+	serviceAudioOut_t	audioOut;
+	serviceDataOut_t	dataOut;
+	serviceBytesOut_t	bytesOut;
+	serviceQuality_t	programQuality;
+	serviceMotdata_t	motdata;
+} serviceCallbacks;
+//
+//	and the statistics per decoded service
+typedef struct {
+	int32_t	SId;
+	int16_t	subchId;
+	bool	isAudio;
+	int16_t	bitRate;
+	int64_t	samplesOut;	// audio, PCM samples
+	int64_t	bytesOut;	// data, bytes
+	int16_t	frameQuality;	// as with programQuality_t
+	int16_t	rsQuality;
+	int16_t	aacQuality;
+	int32_t	framesOut;	// data, e.g. TDC frames
+	int32_t	frameErrors;	// data, frames with a crc error
+} serviceStats;
+//
+//	The EPG (SPI, ETSI TS 102 371) objects - MOT objects with
+//	content type 7 - are decoded by the library, the programmes
+//	are kept and can be queried with dab_getProgrammes, which calls
+	typedef struct {
+	   uint32_t	SId;
+	   uint32_t	shortId;
+	   int64_t	startTime;	// seconds since 1970, UTC
+	   int32_t	duration;	// seconds
+	   const char	*id;		// the crid
+	   const char	*name;		// the longest name given
+	   const char	*description;	// the longest description given
+	} epgProgramme;
+	typedef void (*epgProgramme_t)(const epgProgramme *, void *);
+//	for each programme found. The strings are only valid during the call
+//
+//	dab_getEnsemble calls a function for each service component in
+//	the ensemble that is completely known - audio or packet data -
+//	all taken from one and the same copy of the ensemble database
+	typedef struct {
+	   uint32_t	SId;
+	   const char	*label;		// the service label
+	   int16_t	componentNr;	// 0 for the primary component
+	   bool		isAudio;
+	   audiodata	ad;		// if isAudio
+	   packetdata	pd;		// otherwise
+	   uint16_t	pNum;		// programme number, 0 if unknown
+	   uint32_t	version;	// see dab_getEnsembleChanges
+	} ensembleComponent;
+	typedef void (*ensembleComponent_t)(const ensembleComponent *, void *);
+//	the label is only valid during the call
+
+/////////////////////////////////////////////////////////////////////////
+//
+//	Threads and instances
+//	Each handle returned by dabInit is independent: there is no
+//	mutable state shared between handles (the only shared objects
+//	are the set of fft plans, creation of which is serialized, and
+//	the pool of backend workers, see dab_setBackendThreads), so
+//	a program may run as many handles - each with its own device -
+//	as it likes, from whatever threads.
+//	For a single handle:
+//	- dabStartProcessing, dabReset, dabRetune, dabStop and dabExit
+//	  are to be called from one controlling thread;
+//	- the functions for selecting services and for querying the
+//	  ensemble may be called from any thread, also concurrently;
+//	- the callbacks are called from threads of the library: the
+//	  ensemble, program name, fib quality, sync and system data
+//	  callbacks from the processor thread, the audio, data, bytes,
+//	  quality and mot object callbacks from the workers handling the
+//	  backends, the motdata callback from the thread writing the
+//	  files. A callback should not call dabReset, dabRetune,
+//	  dabStop or dabExit for its own handle.
+//	  The bytes and mot object callbacks of a packet data service
+//	  are called while the streams of its subchannel are locked:
+//	  from these callbacks, do not select or remove services
+//	  either (set_audioChannel, set_dataChannel, dabReset_msc,
+//	  dab_startDecodeAll, dab_stopDecodeAll), that would wait for
+//	  the lock forever. Hand such a request to another thread.
+//	The userData pointer is passed unchanged to the callbacks.
+//
 /////////////////////////////////////////////////////////////////////////
 //
 //	The API functions
@@ -186,14 +298,88 @@ void	dabReset	(void *);
 //	dabStop will stop operation of the functions in the library
 void	dabStop		(void *);
 //
+//	dabRetune is the fast alternative for dabReset when changing
+//	channels: call it after the device is set to the new frequency.
+//	Input buffers are flushed, the services removed and the
+//	synchronization and FIC handling restarted, without stopping
+//	the threads of the library. Returns when done, false
+//	if the library was not running (use dabReset then) or the
+//	request timed out
+bool	dabRetune	(void *);
+//
+//	dab_setMotObjectHandler registers (NULL: removes) the function
+//	that receives the completed MOT objects in memory, writeFiles
+//	tells whether slides are still written to file (and passed to
+//	the motdata_t function of dabInit). The default is no object
+//	handler and writing files
+void	dab_setMotObjectHandler	(void *, motObject_t, bool writeFiles);
+//
 //	dabReset_msc will terminate the operation of active audio and/or data
 //	handlers (there may be more than one active!).
 //	If selecting a service (or services),
 //	normal operation is to call first
 //	on dabReset_msc, and then call set_xxxChannel for
-//	the requested services
+//	the requested services.
+//	The msc handling itself continues and keeps the data of the
+//	last 16 CIFs, so a newly selected service starts without the
+//	usual delay of the time deinterleaver
 void	dabReset_msc		(void *);
 //
+//	The selected services are handled by a pool of worker threads,
+//	rather than by a thread per service. dab_setBackendThreads sets
+//	the number of workers, 0 (the default) means the number of
+//	cores minus two - leaving room for the ofdm and the msc
+//	handling threads - with a minimum of 1.
+//	The pool is shared by all handles in the process, so the number
+//	applies to all of them (the last call counts)
+void	dab_setBackendThreads	(void *, int);
+//
+//	dab_startDecodeAll switches to "decode all" mode: backends
+//	are created for all services (audio and packet data) the FIC
+//	announces, and - as long as the mode is on - the set of backends
+//	follows the changes in the FIC (reconfigurations).
+//	The output of each service is passed on through the
+//	serviceCallbacks, labelled with the SId
+//	(a NULL for any of the callbacks is allowed).
+//	An audio subchannel shared by more services is decoded once,
+//	its output is passed on for each of these SIds
+void	dab_startDecodeAll	(void *, serviceCallbacks *, void *);
+//
+//	dab_stopDecodeAll stops the "decode all" mode, the backends
+//	created for it are removed
+void	dab_stopDecodeAll	(void *);
+//
+//	dab_getServiceStats fills at most "max" entries in the array
+//	and returns the number of services decoded in "decode all" mode,
+//	services sharing an audio subchannel each have an entry (with the
+//	counters of the shared decoder)
+int	dab_getServiceStats	(void *, serviceStats *, int max);
+//
+//	dab_getProgrammes calls the function for each programme of the
+//	service (SId 0: of all services) that is on the air somewhere in
+//	the interval [from, to) - seconds since 1970, UTC - ordered by
+//	SId and starting time, and returns the number of programmes.
+int	dab_getProgrammes	(void *, uint32_t SId,
+	                         int64_t from, int64_t to,
+	                         epgProgramme_t, void *);
+//
+//	dab_exportEPG writes the programmes known as an XML (SPI like)
+//	document to the file, it returns false if the file could not
+//	be written
+bool	dab_exportEPG		(void *, const char *fileName);
+//
+//	The UDP datagrams of IP datacasting services (DSCTy 59) are
+//	forwarded to a local socket: dab_setIPSink sets the IPv4 address
+//	and the port (0: the destination port of each datagram). NULL
+//	as address stops the forwarding, which is the default. Returns
+//	false for an invalid address or when no socket can be opened
+bool	dab_setIPSink		(void *, const char *address, int port);
+//
+//	dab_setIPTunnel: for fd >= 0 the complete IP packets are written
+//	to the descriptor - e.g. of a TUN device opened by the caller -
+//	instead of to the socket, -1 stops that
+void	dab_setIPTunnel		(void *, int fd);
+//
 //	is_audioService will return true id the main service with the
 //	name is an audioservice
 bool	is_audioService		(void *, const char *);
@@ -217,6 +403,20 @@ void	dataforDataService	(void *, const char *, packetdata *, int);
 //	to the list of active handlers
 void	set_audioChannel	(void *, audiodata *);
 //
+//	set_audioChannel_ex does the same, but lets the caller choose,
+//	per service, the form in which the audio is delivered.
+//	With anything other than AUDIO_OUT_PCM the decoder is skipped,
+//	and the audioOut_t callback is passed the encoded bytes (cast
+//	to int16_t *), the size in bytes and a rate of 0.
+//	The faad decoder cannot be told about the 960 sample transform
+//	in ADTS headers, so framed DAB+ audio is delivered as LOAS/LATM.
+//	For DAB (MP2) services all encoded formats give plain MP2 frames.
+#define	AUDIO_OUT_PCM	0	// decoded 16 bit pcm samples
+#define	AUDIO_OUT_LATM	1	// DAB+: LOAS/LATM frames, one per AU
+#define	AUDIO_OUT_AAC	2	// DAB+: raw AAC access units
+#define	AUDIO_OUT_MP2	3	// DAB: MP2 frames (DAB+: as LATM)
+void	set_audioChannel_ex	(void *, audiodata *, int);
+//
 //	set-dataChannel will add - if properly defined - a handler
 //	for handling the packetdata as described in the parameter
 //	to the list of active handlers
@@ -227,6 +427,39 @@ int32_t dab_getSId		(void *, const char*);
 //
 //	and the other way around, mapping the service identifier to a name
 std::string dab_getserviceName	(void *, int32_t);
+//
+//	dab_getEnsembleChanges returns a counter that is incremented on
+//	each change in the ensemble database (services, components,
+//	subchannels, labels). Polling it is cheap, a client only has
+//	to query the services again when the value differs from the
+//	value seen before.
+uint32_t dab_getEnsembleChanges	(void *);
+//
+//	dab_getEnsemble calls the function for each service component
+//	(see ensembleComponent above), ordered as announced in the FIC,
+//	and returns the number of components. One call gives a consistent
+//	picture of the whole ensemble, no need for a query per service
+int	dab_getEnsemble		(void *, ensembleComponent_t, void *);
+//
+//	The warm start cache: with a directory set, the ensemble database
+//	is saved - per frequency - once it is complete and stable.
+//	dab_setEnsembleCache sets the directory, NULL (the default)
+//	switches the cache off. Returns false if the directory cannot
+//	be written.
+bool	dab_setEnsembleCache	(void *, const char *directory);
+//
+//	dab_preloadEnsemble tells the library the frequency the device
+//	is tuned to - call it after dabStartProcessing or dabRetune - and
+//	installs the ensemble cached for it, if any, such that services
+//	can be selected without waiting for the FIC. The programname
+//	callback is called for the cached services.
+//	The FIC validates the cache: it is dropped if the EId differs,
+//	entries not seen in the FIC within some 10 seconds are removed
+//	and entries that differ are updated, as always reported through
+//	dab_getEnsembleChanges. A reconfiguration announced in the FIC
+//	removes the cached file.
+//	Returns false if nothing was cached for the frequency
+bool	dab_preloadEnsemble	(void *, int32_t frequency);
 }
 #endif
 
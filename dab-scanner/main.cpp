@@ -338,7 +338,8 @@ bool firstEnsemble = true;
 	   theDevice	-> restartReader (frequency);
 	   
 	   ensembleRecognized.	store (false);
-	   dabReset (theRadio);
+	   if (!dabRetune (theRadio))
+	      dabReset (theRadio);
 //	The device should be working right now
 
 	   fprintf (stderr, "checking data in channel %s\n",
@@ -128,8 +128,11 @@ void	rtl_tcp_client:: run (void) {
 //	uint8_t to std::complex<float>
 int32_t	rtl_tcp_client::getSamples (std::complex<float> *V, int32_t size) { 
 int32_t	amount, i;
-std::vector<uint8_t> tempBuffer (2 * size);
 //
+//	the conversion buffer only grows, after the first few calls
+//	no allocation takes place here
+	if (tempBuffer. size () < (uint32_t)(2 * size))
+	   tempBuffer. resize (2 * size);
 	amount = theBuffer	-> getDataFromBuffer (tempBuffer. data (), 2 * size);
 	for (i = 0; i < amount / 2; i ++)
 	    V [i] = std::complex<float> (
@@ -39,6 +39,7 @@
 #include        <thread>
 #include        <atomic>
 #include        <stdint.h>
+#include	<vector>
 
 #include	"dab-constants.h"
 #include	"device-handler.h"
@@ -76,6 +77,7 @@ virtual	void		run		(void);
 
 	int32_t		theRate;
 	RingBuffer<uint8_t>	*theBuffer;
+	std::vector<uint8_t>	tempBuffer;	// used by getSamples
 	int		theSocket;
         struct sockaddr_in server;
 	std::thread     threadHandle;
@@ -563,7 +563,7 @@ int	theDuration	= -1;		// infinite
         }
 
         dabReset_msc (theRadio);
-        set_audioChannel (theRadio, &ad);
+        set_audioChannel_ex (theRadio, &ad, AUDIO_OUT_LATM);
 
 	while (run. load () && (theDuration != 0)) {
 	   if (theDuration > 0)
@@ -76,10 +76,58 @@ void	dabStop		(void *Handle) {
 	((dabProcessor *)Handle) -> stop ();
 }
 
+bool	dabRetune	(void *Handle) {
+	return ((dabProcessor *)Handle) -> retune ();
+}
+
+void	dab_setMotObjectHandler	(void *Handle,
+	                         motObject_t h, bool writeFiles) {
+	((dabProcessor *)Handle) -> setMotObjectHandler (h, writeFiles);
+}
+
+int	dab_getProgrammes	(void *Handle, uint32_t SId,
+	                         int64_t from, int64_t to,
+	                         epgProgramme_t h, void *ctx) {
+	return ((dabProcessor *)Handle) -> getProgrammes (SId, from, to,
+	                                                 h, ctx);
+}
+
+bool	dab_exportEPG		(void *Handle, const char *fileName) {
+	return ((dabProcessor *)Handle) -> exportEPG (std::string (fileName));
+}
+
+bool	dab_setIPSink		(void *Handle, const char *address, int port) {
+	return ((dabProcessor *)Handle) -> setIPSink (address == nullptr ?
+	                                              std::string ("") :
+	                                              std::string (address),
+	                                              port);
+}
+
+void	dab_setIPTunnel		(void *Handle, int fd) {
+	((dabProcessor *)Handle) -> setIPTunnel (fd);
+}
+
 void	dabReset_msc	(void *Handle) {
 	((dabProcessor *)Handle) -> reset_msc ();
 }
 
+void	dab_setBackendThreads	(void *Handle, int nrThreads) {
+	((dabProcessor *)Handle) -> set_backendThreads (nrThreads);
+}
+
+void	dab_startDecodeAll	(void *Handle,
+	                         serviceCallbacks *cb, void *userData) {
+	((dabProcessor *)Handle) -> startDecodeAll (cb, userData);
+}
+
+void	dab_stopDecodeAll	(void *Handle) {
+	((dabProcessor *)Handle) -> stopDecodeAll ();
+}
+
+int	dab_getServiceStats	(void *Handle, serviceStats *s, int max) {
+	return ((dabProcessor *)Handle) -> getServiceStats (s, max);
+}
+
 bool	is_audioService	(void *Handle, const char *name) {
 	return ((dabProcessor *)Handle) -> kindofService (std::string (name)) ==
 	                               AUDIO_SERVICE;
@@ -105,6 +153,10 @@ void    set_audioChannel        (void *Handle, audiodata *ad) {
 	((dabProcessor *)Handle) -> set_audioChannel (ad);
 }
 
+void    set_audioChannel_ex     (void *Handle, audiodata *ad, int format) {
+	((dabProcessor *)Handle) -> set_audioChannel (ad, format);
+}
+
 void    set_dataChannel         (void *Handle, packetdata *pd) {
 	((dabProcessor *)Handle) -> set_dataChannel (pd);
 }
@@ -118,3 +170,20 @@ std::string dab_getserviceName (void *Handle, int32_t SId) {
 	return ((dabProcessor *)Handle) -> get_serviceName (SId);
 }
 
+uint32_t dab_getEnsembleChanges (void *Handle) {
+	return ((dabProcessor *)Handle) -> get_ensembleChanges ();
+}
+
+int	dab_getEnsemble	(void *Handle, ensembleComponent_t h, void *ctx) {
+	return ((dabProcessor *)Handle) -> getEnsemble (h, ctx);
+}
+
+bool	dab_setEnsembleCache	(void *Handle, const char *directory) {
+	return ((dabProcessor *)Handle) -> setEnsembleCache (
+	                         directory == nullptr ? "" : directory);
+}
+
+bool	dab_preloadEnsemble	(void *Handle, int32_t frequency) {
+	return ((dabProcessor *)Handle) -> preloadEnsemble (frequency);
+}
+
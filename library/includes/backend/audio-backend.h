@@ -32,9 +32,11 @@
 #include	"dab-api.h"
 #include	"virtual-backend.h"
 #include	"ringbuffer.h"
-#include	"semaphore.h"
+#include	"time-deinterleaver.h"
 
 class	backendBase;
+class	backendPool;
+class	motSink;
 class	protection;
 class	audioSink;
 
@@ -45,17 +47,20 @@ public:
 	                 dataOut_t,
 	                 programQuality_t,
 	                 motdata_t,
+	                 motSink *,
+	                 int16_t,		// output format
+	                 backendPool *,
 	                 void	*);
 	~audioBackend	(void);
-int32_t	process		(int16_t *, int16_t);
+int32_t	process		(cifBuffer *, int32_t, int16_t);
 void	stopRunning	(void);
 void	start		(void);
+void	processPending	(void);
+bool	sameSubchannel	(int16_t, int16_t, bool, int16_t, int16_t);
+void	primeHistory	(std::vector<cifBuffer *> &);
 private:
-	void		run		(void);
-	void		processSegment	(int16_t *);
-
+	backendPool	*thePool;
 	std::atomic<bool>	running;
-	std::thread	threadHandle;
 	uint8_t		dabModus;
 	int16_t		fragmentSize;
 	int16_t		bitRate;
@@ -63,16 +68,8 @@ private:
 	int16_t		protLevel;
 	std::vector<uint8_t> outV;
 	std::vector<uint8_t> disperseVector;
-	int16_t		**interleaveData;
-	int16_t		interleaverIndex;
-	int16_t		countforInterleaver;
-	std::vector<int16_t> tempX;
-
-	Semaphore	freeSlots;
-	Semaphore	usedSlots;
-	int16_t		nextIn;
-	int16_t		nextOut;
-	int16_t		*theData [20];
+	timeDeinterleaver deInterleaver;
+	std::vector<int8_t> tempX;
 
 	protection	*protectionHandler;
 	backendBase	*our_backendBase;
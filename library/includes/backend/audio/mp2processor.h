@@ -54,6 +54,8 @@ public:
 	                                 dataOut_t,
 	                                 programQuality_t,
 	                                 motdata_t,
+	                                 motSink *,
+	                                 int16_t,		// output format
 	                                 void	*);
 			~mp2Processor	(void);
 	void		addtoFrame	(uint8_t *);
@@ -63,6 +65,7 @@ private:
 	dataOut_t	dataOut;
 	programQuality_t	mscQuality;
 	void		*ctx;
+	int16_t		outputFormat;
 	int16_t		bitRate;
 	padHandler	my_padHandler;
 	void		output		(int16_t *, int, int, bool);
@@ -33,7 +33,7 @@
 #include	"backend-base.h"
 #include	"dab-api.h"
 #include	"firecode-checker.h"
-#include	"reed-solomon.h"
+#include	"rs-superframe.h"
 #include	"faad-decoder.h"
 #include	"pad-handler.h"
 
@@ -45,6 +45,8 @@ public:
 	                                 dataOut_t,
 	                                 programQuality_t,
 	                                 motdata_t,
+	                                 motSink *,
+	                                 int16_t,		// output format
 	                                 void	*);
 			~mp4Processor	(void);
 	void		addtoFrame	(uint8_t *);
@@ -66,6 +68,8 @@ private:
 	int16_t		superFramesize;
 	int16_t		blockFillIndex;
 	int16_t		blocksInBuffer;
+	bool		inSync;
+	bool		fireCodeOK	[5];
 	int16_t		blockCount;
 	int16_t		bitRate;
 	std::vector<uint8_t> frameBytes;
@@ -75,9 +79,10 @@ private:
 	int32_t		baudRate;
 
 	firecode_checker	fc;
-	reedSolomon	my_rsDecoder;
-//	and for the aac decoder
-	faadDecoder	aacDecoder;
+	rsSuperframe	my_rsDecoder;
+//	and for the aac decoder, only with PCM output
+	int16_t		outputFormat;
+	faadDecoder	*aacDecoder;
 
 	int16_t		frameCount;
 	int16_t		successFrames;
@@ -0,0 +1,74 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__BACKEND_POOL__
+#define	__BACKEND_POOL__
+
+#include	<stdint.h>
+#include	<thread>
+#include	<mutex>
+#include	<condition_variable>
+#include	<atomic>
+#include	<deque>
+#include	<vector>
+
+class	virtualBackend;
+//
+//	A fixed set of worker threads, shared by all backends of
+//	all msc handlers in the process, rather than a thread per backend.
+//	The pool is reference counted: acquire creates it for the first
+//	msc handler, release deletes it with the last one.
+//	A backend with pending fragments is scheduled (at most once,
+//	see virtualBackend), a worker takes it from the readyList and
+//	handles all its pending fragments, so for a given backend the
+//	fragments are handled in order, and by one worker at the time.
+class	backendPool {
+public:
+static	backendPool	*acquire	(void);
+static	void		release		(void);
+	void	schedule	(virtualBackend *);
+//	a backend signals that it has no more fragments pending,
+//	waitIdle waits for that (see virtualBackend)
+	void	backendIdle	(void);
+	void	waitIdle	(std::atomic<int32_t> *);
+//	0 means: chosen by the library, based on the number of cores,
+//	the number applies to all handlers sharing the pool
+	void	setThreads	(int16_t);
+	int16_t	nrThreads	(void);
+private:
+		backendPool	(int16_t nrThreads = 0);
+		~backendPool	(void);
+	void	run		(void);
+	void	startWorkers	(int16_t);
+	void	stopWorkers	(void);
+	std::mutex	workerLocker;		// serializes setThreads
+	std::vector<std::thread> workers;
+	std::deque<virtualBackend *> readyList;
+	std::mutex	locker;
+	std::condition_variable	waiter;
+	std::condition_variable	idleWaiter;
+	std::atomic<bool>	running;
+};
+
+#endif
+
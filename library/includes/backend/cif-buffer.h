@@ -0,0 +1,68 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__CIF_BUFFER__
+#define	__CIF_BUFFER__
+
+#include	<stdint.h>
+#include	<atomic>
+#include	<mutex>
+#include	<vector>
+
+class	cifPool;
+//
+//	A cifBuffer holds the soft bits of one complete CIF.
+//	The msc handler fills it and passes it - by reference, not
+//	by copying - to all backends, the time deinterleaver of
+//	a backend keeps a reference for as long as it needs the
+//	data, i.e. 16 CIFs. The last unref returns the buffer to
+//	the pool it came from.
+class	cifBuffer {
+public:
+		cifBuffer	(cifPool *, int32_t);
+		~cifBuffer	(void);
+	int8_t	*data		(void);
+	void	ref		(void);
+	void	unref		(void);
+private:
+	friend	class cifPool;
+	cifPool			*owner;
+	std::vector<int8_t>	buffer;
+	std::atomic<int32_t>	refCount;
+};
+
+class	cifPool {
+public:
+		cifPool		(int32_t cifSize);
+		~cifPool	(void);
+//	get returns a buffer with a reference count of 1
+	cifBuffer	*get	(void);
+private:
+	friend	class cifBuffer;
+	void		put	(cifBuffer *);
+	int32_t		cifSize;
+	std::mutex	locker;
+	std::vector<cifBuffer *> freeList;
+};
+#endif
+
@@ -28,25 +28,42 @@
 #include        <mutex>
 #include	<atomic>
 #include	<vector>
-#include	"semaphore.h"
 #include	"dab-api.h"
 #include	"virtual-backend.h"
 #include	"ringbuffer.h"
+#include	"time-deinterleaver.h"
 
-class	backendBase;
+class	dataProcessor;
+class	backendPool;
+class	motSink;
+class	ipSink;
 class	protection;
+//
+//	The dataBackend does the FEC for a packet mode subchannel,
+//	the packet streams in it are added and removed by the
+//	msc handler, see dataProcessor
 
 class	dataBackend: public virtualBackend {
 public:
 		dataBackend	(packetdata	*,
+	                         backendPool	*thePool);
+		~dataBackend	(void);
+	int16_t	addStream	(packetdata	*,
 	                         bytesOut_t	bytesOut,
 	                         motdata_t	motdataHandler,
+	                         motSink	*theSink,
+	                         ipSink		*theIPSink,
 	                         void		*userData);
-		~dataBackend	(void);
-	int32_t	process		(int16_t *, int16_t);
+	int16_t	removeStream	(int16_t);
+	void	getStreamStats	(int16_t, int32_t &, int32_t &);
+	bool	sameSubchannel	(int16_t, int16_t, bool, int16_t, int16_t);
+	void	primeHistory	(std::vector<cifBuffer *> &);
+	int32_t	process		(cifBuffer *, int32_t, int16_t);
 	void	stopRunning	(void);
 	void	start		(void);
+	void	processPending	(void);
 private:
+	backendPool	*thePool;
 	uint8_t		DSCTy;
 	int16_t		fragmentSize;
 	int16_t		bitRate;
@@ -56,24 +73,14 @@ private:
 	int16_t		FEC_scheme;
 	bool		show_crcErrors;
 	int16_t		crcErrors;
-void	run		(void);
 	std::atomic<bool>	running;
-	std::thread	threadHandle;
-	int16_t		interleaverIndex;
-	int16_t		countforInterleaver;
 	std::vector<uint8_t> outV;
-	std::vector<int16_t>	tempX;
+	std::vector<int8_t>	tempX;
 	std::vector<uint8_t>	disperseVector;
-	int16_t		**interleaveData;
-	Semaphore	freeSlots;
-	Semaphore	usedSlots;
-
-	int16_t		*theData [20];
-	int16_t		nextIn;
-	int16_t		nextOut;
+	timeDeinterleaver deInterleaver;
 
 	protection	*protectionHandler;
-	backendBase	*our_backendBase;
+	dataProcessor	*our_backendBase;
 };
 
 #endif
@@ -26,39 +26,69 @@
 #include	<stdio.h>
 #include	<string.h>
 #include	<vector>
+#include	<mutex>
 #include	"dab-api.h"
 #include	"backend-base.h"
+#include	"datagroup-pool.h"
 
 class	virtual_dataHandler;
-
+class	motSink;
+class	ipSink;
+//
+//	The dataProcessor handles the packets of a subchannel.
+//	A subchannel may carry more packet streams, identified by
+//	the packet address, and a stream may be asked for by more
+//	clients. Each (address, client) pair is a stream with its
+//	own datagroup assembly and datahandler, the FEC of the
+//	subchannel is done once, the packets are dispatched to the
+//	streams on their address.
 class	dataProcessor:public backendBase {
 public:
-	dataProcessor	(int16_t	bitRate,
-	                 packetdata	*pd,
+	dataProcessor	(int16_t	bitRate);
+	~dataProcessor	(void);
+void	addtoFrame	(uint8_t *);
+//
+//	addStream returns a stream id, for a second request for the
+//	same stream the reference count is incremented
+int16_t	addStream	(packetdata	*pd,
 	                 bytesOut_t     bytesOut,
 	                 motdata_t	motdataHandler,
+	                 motSink	*theSink,
+	                 ipSink		*theIPSink,
 	                 void		*ctx);
-	~dataProcessor	(void);
-void	addtoFrame	(uint8_t *);
+//	removeStream returns the number of streams left
+int16_t	removeStream	(int16_t);
+void	getStreamStats	(int16_t, int32_t &, int32_t &);
 private:
+	struct packetStream {
+	   int16_t	id;
+	   int16_t	refCount;
+	   int16_t	packetAddress;
+	   uint8_t	DSCTy;
+	   int16_t	appType;
+	   uint8_t	DGflag;
+	   bytesOut_t	bytesOut;
+	   motdata_t	motdataHandler;
+	   void		*ctx;
+	   dataGroup	series;
+	   uint8_t	packetState;
+	   virtual_dataHandler *my_dataHandler;
+	};
 	int16_t		bitRate;
-	uint8_t		DSCTy;
-	int16_t		appType;
-	int16_t		packetAddress;
-	uint8_t		DGflag;
-	int16_t		FEC_scheme;
-	bytesOut_t	bytesOut;
-	void		*ctx;
 	int16_t		crcErrors;
 	int16_t		handledPackets;
-	std::vector<uint8_t> series;
-	uint8_t		packetState;
+	int16_t		nextId;
+	bool		asyncStream;
+	std::mutex	streamLocker;
+	dataGroupPool	groupPool;
+	std::vector<packetStream *> streams;
 //
 //	result handlers
 	void		handleTDCAsyncstream 	(uint8_t *, int16_t);
 	void		handlePackets		(uint8_t *, int16_t);
 	void		handlePacket		(uint8_t *);
-	virtual_dataHandler *my_dataHandler;
+	void		addtoStream		(packetStream *,
+	                                         uint8_t *, int16_t, int16_t);
 };
 
 #endif
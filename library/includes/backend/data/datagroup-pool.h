@@ -0,0 +1,79 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__DATAGROUP_POOL__
+#define	__DATAGROUP_POOL__
+
+#include	<stdint.h>
+#include	<mutex>
+#include	<utility>
+#include	<vector>
+
+class	dataGroupPool;
+//
+//	A dataGroup is a handle to a pooled buffer in which an
+//	MSC datagroup is assembled. The handle can be moved, not
+//	copied, so there is always a single owner of the buffer.
+//	The buffer goes back to its pool when the handle is
+//	destroyed (or overwritten), keeping its capacity, so - after
+//	a few datagroups - assembly and dispatch do not allocate.
+//	Handles are to be released before the pool is deleted.
+class	dataGroup {
+public:
+		dataGroup	(void);
+		dataGroup	(dataGroup &&);
+		~dataGroup	(void);
+	dataGroup &operator =	(dataGroup &&);
+		dataGroup	(const dataGroup &) = delete;
+	dataGroup &operator =	(const dataGroup &) = delete;
+	bool	isValid		(void) const;
+	uint8_t	*data		(void);
+	int32_t	size		(void) const;
+	void	clear		(void);
+	void	append		(const uint8_t *, int32_t);
+//	pack turns the bits - one per byte - into bytes, in place,
+//	and returns the new size (in bytes)
+	int32_t	pack		(void);
+	void	release		(void);
+private:
+	friend	class dataGroupPool;
+		dataGroup	(dataGroupPool *, std::vector<uint8_t> *);
+	dataGroupPool		*owner;
+	std::vector<uint8_t>	*buffer;
+};
+
+class	dataGroupPool {
+public:
+		dataGroupPool	(int32_t initialSize = 8192);
+		~dataGroupPool	(void);
+//	get returns a handle to an empty buffer
+	dataGroup	get	(void);
+private:
+	friend	class dataGroup;
+	void		put	(std::vector<uint8_t> *);
+	int32_t		initialSize;
+	std::mutex	locker;
+	std::vector<std::vector<uint8_t> *> freeList;
+};
+#endif
+
@@ -0,0 +1,107 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__EPG_DECODER__
+#define	__EPG_DECODER__
+
+#include	<stdint.h>
+#include	<string>
+#include	<vector>
+#include	<deque>
+#include	<mutex>
+#include	"dab-api.h"
+
+//
+//	The epgDecoder decodes the binary encoded EPG (SPI) objects
+//	(ETSI TS 102 371) as they come out of the MOT, in a single
+//	pass over the tag-length-value structure, without building
+//	a document.
+//	Per programme only what is needed for the query API is kept:
+//	a fixed size record, with the strings as offsets in one
+//	string pool.
+//	An object that is received again (a new version) replaces the
+//	programmes of its predecessor, the number of programmes kept
+//	is bounded, the programmes of the oldest objects go first.
+class	epgDecoder {
+public:
+		epgDecoder	(int32_t maxProgrammes = 8192);
+		~epgDecoder	(void);
+//	returns the number of programmes found in the object, -1 if
+//	the object is not a (well formed) programme information object
+	int32_t	decode		(const uint8_t *, int32_t,
+	                         const std::string &);
+	int32_t	getProgrammes	(uint32_t, int64_t, int64_t,
+	                         epgProgramme_t, void *);
+	bool	exportXml	(const std::string &);
+	void	clear		(void);
+private:
+	struct programme {
+	   uint32_t	SId;
+	   uint32_t	shortId;
+	   int64_t	startTime;
+	   int32_t	duration;
+	   uint32_t	origin;		// the object it came from
+	   uint32_t	id;		// offsets in the pool, 0 is ""
+	   uint32_t	shortName;
+	   uint32_t	mediumName;
+	   uint32_t	longName;
+	   uint32_t	shortDescription;
+	   uint32_t	longDescription;
+	};
+	struct origin {
+	   std::string	name;
+	   uint32_t	sequence;
+	};
+	struct tlv {
+	   uint8_t		tag;
+	   const uint8_t	*value;
+	   int32_t		length;
+	};
+	bool		nextTLV		(const uint8_t *&,
+	                                 const uint8_t *, tlv &);
+	void		handle_epg	(const tlv &);
+	void		handle_schedule	(const tlv &);
+	void		handle_scope	(const tlv &, uint32_t &);
+	void		handle_programme	(const tlv &, uint32_t);
+	void		handle_location	(const tlv &, programme &);
+	uint32_t	handle_text	(const tlv &);
+	void		set_tokenTable	(const tlv &);
+	uint32_t	addString	(const uint8_t *, int32_t);
+	uint32_t	contentId	(const uint8_t *, int32_t);
+	int64_t		timePoint	(const uint8_t *, int32_t);
+	void		removeOrigin	(uint32_t);
+	void		compact		(void);
+	const char	*getString	(uint32_t);
+	std::mutex	locker;
+	std::vector<programme>	programmes;
+	std::vector<char>	pool;
+	std::deque<origin>	origins;
+	std::string	tokens [20];
+	int32_t		maxProgrammes;
+	size_t		poolLimit;
+	uint32_t	sequence;
+	uint32_t	defaultSId;
+	int32_t		found;
+};
+#endif
+
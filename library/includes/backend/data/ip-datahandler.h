@@ -24,28 +24,28 @@
 #define	IP_DATAHANDLER
 #include	"dab-constants.h"
 #include	"virtual-datahandler.h"
-#include	<QByteArray>
-
-class	RadioInterface;
+#include	"ip-sink.h"
 
+//
+//	IP datacasting (DSCTy 59): each MSC datagroup carries an IP
+//	datagram. The datagroup is packed - in place - to bytes, the
+//	IP and UDP headers are checked and the datagram is kept, with
+//	the datagroup it lives in, until the end of the frame, when
+//	the batch is passed to the ipSink
 class	ip_dataHandler:public virtual_dataHandler {
-Q_OBJECT
 public:
-		ip_dataHandler		(RadioInterface *, bool);
+		ip_dataHandler		(ipSink *);
 		~ip_dataHandler		(void);
-	void	add_mscDatagroup	(QByteArray &);
+	void	add_mscDatagroup	(dataGroup);
+	void	flush			(void);
 private:
-	void	process_ipVector	(QByteArray &);
-	void	process_udpVector	(uint8_t *, int16_t);
-	bool	show_crcErrors;
-	int16_t	handledPackets;
-	int16_t	crcErrors;
-signals:
-	void	writeDatagram		(char *, int);
-	void	show_ipErrors		(int);
+	bool	process_ipVector	(const uint8_t *, int32_t,
+	                                 ipDatagram &);
+	ipSink		*theSink;
+	dataGroup	pending		[IP_MAX_BATCH];
+	ipDatagram	datagrams	[IP_MAX_BATCH];
+	int16_t		nrPending;
 };
 
 #endif
 
-
-
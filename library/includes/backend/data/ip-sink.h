@@ -0,0 +1,80 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__IP_SINK__
+#define	__IP_SINK__
+
+#include	<stdint.h>
+#include	<string>
+#include	<mutex>
+#include	<atomic>
+#include	<sys/socket.h>
+#include	<netinet/in.h>
+#include	<sys/uio.h>
+
+#define	IP_MAX_BATCH	32
+//
+//	A datagram as found by an ip_dataHandler, the pointers
+//	refer to the (packed) datagroup it came in
+struct	ipDatagram {
+	const uint8_t	*packet;	// the IP packet
+	int32_t		packetLength;
+	const uint8_t	*payload;	// the UDP payload
+	int32_t		payloadLength;
+	uint16_t	dstPort;
+};
+//
+//	The ipSink - one per mscHandler - forwards the datagrams of
+//	the IP datacasting services. Either the UDP payloads are sent
+//	to a local address - with one sendmmsg for a batch - or the
+//	complete IP packets are written to a file descriptor, e.g. of
+//	a TUN device. Nothing is copied, the iovecs point into the
+//	datagroups.
+//	With a tunnel set, the datagrams go to the tunnel only
+class	ipSink {
+public:
+		ipSink		(void);
+		~ipSink		(void);
+//	port 0: the destination port of the datagram
+	bool	setDestination	(const std::string &, int);
+	void	setTunnel	(int);
+	bool	isActive	(void);
+//	returns the number of datagrams sent
+	int32_t	send		(const ipDatagram *, int16_t);
+private:
+	std::mutex	locker;
+	int		socketHandle;
+	int		tunnelHandle;
+	struct sockaddr_in	destination;
+	int		port;
+	bool		toSocket;
+	std::atomic<bool>	active;
+//	scratch, used under the lock
+#ifdef	__linux__
+	struct mmsghdr	messages	[IP_MAX_BATCH];
+#endif
+	struct iovec	vectors		[IP_MAX_BATCH];
+	struct sockaddr_in addresses	[IP_MAX_BATCH];
+};
+#endif
+
@@ -0,0 +1,58 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__MOT_CACHE__
+#define	__MOT_CACHE__
+
+#include	<stdint.h>
+#include	<string>
+#include	<vector>
+
+//
+//	Carousels repeat their objects every few seconds. The motCache
+//	remembers the objects that were completed (and delivered), keyed
+//	by transportId, name and the crc of the MOT header, so a repeated
+//	object is recognized from its header and its body segments are
+//	skipped. A changed object has a different header, and thus a
+//	different key. The cache is bounded, the least recently seen
+//	entry is dropped.
+class	motCache {
+public:
+		motCache	(int16_t size = 64);
+		~motCache	(void);
+	bool	contains	(uint16_t, const std::string &, uint16_t);
+	void	insert		(uint16_t, const std::string &, uint16_t);
+	void	clear		(void);
+private:
+	struct cacheEntry {
+	   uint16_t	transportId;
+	   uint16_t	headerCrc;
+	   std::string	name;
+	   uint32_t	lastSeen;
+	};
+	std::vector<cacheEntry> entries;
+	int16_t		size;
+	uint32_t	clock;
+};
+#endif
+
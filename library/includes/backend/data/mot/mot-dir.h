@@ -32,6 +32,8 @@
 class	motDirectory {
 public:
 			motDirectory	(motdata_t,
+	                                 motSink *,
+	                                 motCache *,
 	                                 void	*,
 	                                 uint16_t,
 	                                 int16_t,
@@ -49,6 +51,8 @@ public:
 	uint16_t	get_transportId	(void);
 private:
 	motdata_t	motdataHandler;
+	motSink		*theSink;
+	motCache	*theCache;
 	void		*ctx;
 	void		analyse_theDirectory (void);
 	uint16_t	transportId;
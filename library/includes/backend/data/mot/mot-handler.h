@@ -25,23 +25,38 @@
 #include	"virtual-datahandler.h"
 #include	<vector>
 #include	"dab-api.h"
+#include	"mot-cache.h"
 
 class	motObject;
 class	motDirectory;
+class	motSink;
 
 class	motHandler:public virtual_dataHandler {
 public:
 		motHandler	(motdata_t motdataHandler,
+	                         motSink *theSink,
 	                         void	*ctx);
 		~motHandler	(void);
-	void	add_mscDatagroup	(std::vector<uint8_t>);
+	void	add_mscDatagroup	(dataGroup);
 private:
 	motdata_t	motdataHandler;
+	motSink		*theSink;
 	void		*ctx;
 	void		setHandle	(motObject *, uint16_t);
 	motObject	*getHandle	(uint16_t);
 	int		orderNumber;
 	motDirectory	*theDirectory;
+//	the bytes of the current segment, reused for all datagroups
+	std::vector<uint8_t>	motVector;
+//	the objects completed recently, shared with the directory
+	motCache	theCache;
+//
+//	we "cache" the most recent single motSlides (not those in a directory)
+	struct {
+	   uint16_t	transportId;
+	   int32_t	orderNumber;
+	   motObject	*motSlide;
+	} motTable [15];
 };
 #endif
 
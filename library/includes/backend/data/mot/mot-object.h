@@ -25,38 +25,59 @@
 #include	"dab-constants.h"
 #include	"dab-api.h"
 #include	<vector>
-#include        <map>
-#include        <iterator>
+
+class	motSink;
+class	motCache;
+//
+//	The body of a MOT object is assembled in a single buffer,
+//	allocated - with the size from the header - when the first
+//	segment comes in. A bitmap tells which segments are in, a
+//	counter how many, so completeness is known on arrival of
+//	the last one.
+//	Objects larger than this are ignored
+#define	MAX_MOT_BODY	(16 * 1024 * 1024)
 
 class	motObject {
 public:
 		motObject (motdata_t	motdataHandler,
+	                   motSink	*theSink,
+	                   motCache	*theCache,
 	                   bool		dirElement,
 	                   uint16_t	transportId,
-	                   uint8_t	*segment,
+	                   const uint8_t	*segment,
 	                   int32_t	segmentSize,
 	                   bool		lastFlag,
 	                   void		*ctx);
 		~motObject (void);
-	void	addBodySegment (uint8_t	*bodySegment,
+	void	addBodySegment (const uint8_t	*bodySegment,
                                 int16_t	segmentNumber,
                                 int32_t	segmentSize,
 	                        bool	lastFlag);
 	uint16_t	get_transportId (void);
 	int		get_headerSize	(void);
+	uint16_t	get_headerCrc	(void);
+	bool		isComplete	(void);
+//	the crc of the header in the given (header) segment
+static	uint16_t	headerCrc	(const uint8_t *, int32_t);
 private:
 	motdata_t	motdataHandler;
+	motSink		*theSink;
+	motCache	*theCache;
 	bool		dirElement;
 	uint16_t	transportId;
 	int16_t		numofSegments;
 	int32_t		segmentSize;
 	void		*ctx;
 	uint32_t	headerSize;
+	uint16_t	theHeaderCrc;
 	uint32_t	bodySize;
 	int		contentType;
 	int		contentsubType;
 	std::string	name;
-        std::map<int, std::vector<uint8_t>> motMap;
+	std::vector<uint8_t>	body;
+	std::vector<uint64_t>	received;	// 8192 bits
+	int16_t		receivedSegments;
+	bool		complete;
 
 	void		handleComplete	(void);
 };
@@ -0,0 +1,84 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__MOT_SINK__
+#define	__MOT_SINK__
+
+#include	<stdint.h>
+#include	<string>
+#include	<vector>
+#include	<deque>
+#include	<thread>
+#include	<mutex>
+#include	<condition_variable>
+#include	"dab-api.h"
+
+class	epgDecoder;
+
+//
+//	The motSink - one per mscHandler - delivers the completed
+//	MOT objects of all services.
+//	The body is first passed, in memory, to the motObject_t handler
+//	(if any) and then - for slides and if file writing is on - handed
+//	to a writer thread. That one writes the file under /tmp and
+//	calls the motdata_t function of the service with its name, so
+//	the decoders never wait for the file system.
+//	EPG objects (content type 7) are passed to the epgDecoder.
+class	motSink {
+public:
+		motSink		(void);
+		~motSink	(void);
+	void	setObjectHandler	(motObject_t, void *, bool);
+	void	setEPGDecoder		(epgDecoder *);
+//	body is taken over (it is empty on return)
+	void	deliver		(motdata_t, void *,
+	                         const std::string &,
+	                         int, int,
+	                         std::vector<uint8_t> &);
+//	flush returns when all files queued so far are written and
+//	reported, after that no motdata_t call refers to an old context
+	void	flush		(void);
+private:
+	struct fileJob {
+	   std::string		name;
+	   int			contentsubType;
+	   motdata_t		motdataHandler;
+	   void			*ctx;
+	   std::vector<uint8_t>	body;
+	};
+	void		run		(void);
+	motObject_t	objectHandler;
+	epgDecoder	*theEPG;
+	void		*objectCtx;
+	bool		writeFiles;
+	std::mutex	locker;
+	std::condition_variable	jobAvailable;
+	std::condition_variable	jobsDone;
+	std::deque<fileJob>	jobs;
+	bool		busy;
+	bool		stopping;
+	bool		started;
+	std::thread	threadHandle;
+};
+#endif
+
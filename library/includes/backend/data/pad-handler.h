@@ -27,24 +27,28 @@
 #include	<string>
 #include	<vector>
 #include	"dab-api.h"
+#include	"datagroup-pool.h"
+#include	"mot-cache.h"
 
 class	motObject;
+class	motSink;
 
 class	padHandler {
 public:
-		padHandler	(dataOut_t, motdata_t, void *);
+		padHandler	(dataOut_t, motdata_t, motSink *, void *);
 		~padHandler	(void);
 	void	processPAD	(uint8_t *, int16_t, uint8_t, uint8_t);
 private:
 	dataOut_t	dataOut;
 	motdata_t	motdata_Handler;
+	motSink		*theSink;
 	void		*ctx;
 	void		handle_variablePAD	(uint8_t *, int16_t, uint8_t);
 	void		handle_shortPAD		(uint8_t *, int16_t, uint8_t);
 	void		dynamicLabel		(uint8_t *, int16_t, uint8_t);
-	void		new_MSC_element 	(std::vector<uint8_t>);
-	void		add_MSC_element		(std::vector<uint8_t>);
-	void		build_MSC_segment	(std::vector<uint8_t>);
+	void		new_MSC_element 	(const uint8_t *, int16_t);
+	void		add_MSC_element		(const uint8_t *, int16_t);
+	void		build_MSC_segment	(const uint8_t *, int32_t);
 	bool		pad_crc			(uint8_t *, int16_t);
 
 	std::string	dynamicLabelText;
@@ -55,15 +59,24 @@ private:
 	int16_t		xpadLength;
 	int16_t		still_to_go;		// for short pad fragments
 	motObject	*currentSlide;
+//	the slides completed recently, a repeated one is not reassembled
+	motCache	theCache;
 	bool		firstSegment;
 	bool		lastSegment;
 	int16_t		segmentNumber;
+//	for the dynamic label
+	int16_t		segmentno;
+	int16_t		remainDataLength;
+	bool		isLastSegment;
+	bool		moreXPad;
 //      dataGroupLength is set when having processed an appType 1
         int dataGroupLength;
 //
 //      The msc_dataGroupBuffer is - as the name suggests - used for
-//      assembling the msc_data group.
-        std::vector<uint8_t> msc_dataGroupBuffer;
+//      assembling the msc_data group, it is taken from the pool
+//	when a datagroup starts, and returned when it is complete
+	dataGroupPool	groupPool;
+	dataGroup	msc_dataGroupBuffer;
 };
 
 #endif
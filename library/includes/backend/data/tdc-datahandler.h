@@ -22,26 +22,29 @@
 #ifndef		__TDC_DATAHANDLER__
 #define		__TDC_DATAHANDLER__
 
+#include	<atomic>
 #include	"dab-api.h"
 #include	"dab-constants.h"
 #include	"virtual-datahandler.h"
 
+//
+//	TDC (TS 101 759) transport frames - e.g. TPEG - in MSC datagroups.
+//	The datagroup is packed to bytes, the sync words are found with
+//	memchr, the frames are handed to bytesOut directly from the
+//	datagroup buffer.
 class	tdc_dataHandler : public virtual_dataHandler {
 public:
 		tdc_dataHandler		(int16_t appType,
 	                                 bytesOut_t bytesOut, void *ctx);
 		~tdc_dataHandler	(void);
-	void	add_mscDatagroup	(std::vector<uint8_t>);
+	void	add_mscDatagroup	(dataGroup);
+	void	getStats		(int32_t &, int32_t &);
 private:
-        int32_t handleFrame_type_0      (uint8_t *data,
-                                         int32_t offset, int32_t length);
-        int32_t handleFrame_type_1      (uint8_t *data,
-                                         int32_t offset, int32_t length);
-        bool    serviceComponentFrameheaderCRC (uint8_t *, int16_t, int16_t);
+	bool	frameHeaderCRC		(const uint8_t *, int32_t);
 	bytesOut_t	bytesOut;
 	void		*ctx;
+	std::atomic<int32_t>	frames;
+	std::atomic<int32_t>	crcErrors;
 };
 #endif
 
-
-
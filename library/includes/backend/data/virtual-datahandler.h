@@ -24,14 +24,23 @@
 #define	VIRTUAL_DATAHANDLER
 #include	"dab-constants.h"
 #include	<vector>
+#include	"datagroup-pool.h"
 
 
 class	virtual_dataHandler {
 public:
 		virtual_dataHandler	(void);
 virtual		~virtual_dataHandler	(void);
+//	the handler owns the datagroup (one bit per byte) from here on,
+//	it goes back to its pool when the handler releases it
 virtual
-	void	add_mscDatagroup	(std::vector<uint8_t>);
+	void	add_mscDatagroup	(dataGroup);
+//	called at the end of each frame, for handlers that batch
+virtual
+	void	flush			(void);
+//	frames delivered and frames with errors, for handlers that count
+virtual
+	void	getStats		(int32_t &, int32_t &);
 };
 #endif
 
@@ -0,0 +1,115 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__FULL_ENSEMBLE__
+#define	__FULL_ENSEMBLE__
+
+#include	<stdint.h>
+#include	<atomic>
+#include	<mutex>
+#include	<condition_variable>
+#include	<thread>
+#include	<vector>
+#include	<memory>
+#include	"dab-api.h"
+#include	"fib-processor.h"
+
+class	mscHandler;
+class	ficHandler;
+struct	mscChannel;
+//
+//	The fullEnsembleHandler implements the "decode all" mode:
+//	it maintains a backend for each service component in the
+//	list derived from the FIC, the output of the backends is
+//	labelled with the SId and passed on to the serviceCallbacks.
+//	The processor thread calls ensembleChanged with the change
+//	count of the FIC, a control thread of our own then updates the
+//	set of backends: components that disappeared or changed (a
+//	reconfiguration) are removed, new ones are added. Removing a
+//	backend means waiting for it, the processor thread never does.
+//	An audio subchannel shared by more services is decoded once,
+//	the route records the other SIds, its output and its statistics
+//	are passed on for each of them.
+class	fullEnsembleHandler {
+public:
+		fullEnsembleHandler	(mscHandler *, ficHandler *);
+		~fullEnsembleHandler	(void);
+	void	start		(serviceCallbacks *, void *);
+	void	stop		(void);
+	void	ensembleChanged	(uint32_t);
+	void	reset		(void);
+	void	clear		(void);
+	int	getStats	(serviceStats *, int);
+private:
+	struct serviceRoute {
+	   fullEnsembleHandler	*owner;
+	   int32_t		SId;
+	   int16_t		componentNr;
+	   bool			isAudio;
+	   audiodata		ad;
+	   packetdata		pd;
+	   mscChannel		*channel;
+//	the other services on the subchannel, only accessed with
+//	std::atomic_load and std::atomic_store, since the callbacks
+//	read it from the backend threads
+	   std::shared_ptr<const std::vector<int32_t>> sharedBy;
+	   std::vector<int32_t>	sharers;	// update's scratch
+	   std::atomic<int64_t>	samplesOut;
+	   std::atomic<int64_t>	bytesOut;
+	   std::atomic<int16_t>	frameQuality;
+	   std::atomic<int16_t>	rsQuality;
+	   std::atomic<int16_t>	aacQuality;
+	};
+	mscHandler	*theMsc;
+	ficHandler	*theFic;
+	serviceCallbacks	callbacks;
+	void		*userData;
+	std::atomic<bool>	active;
+	std::mutex	locker;
+	std::vector<serviceRoute *> routes;
+//
+//	attached is false after a reset or clear, until the processor
+//	thread calls ensembleChanged again; updates are skipped then.
+//	The control thread is started with the first start
+	std::atomic<bool>	attached;
+	std::atomic<uint32_t>	lastVersion;
+	std::mutex	signalLocker;
+	std::condition_variable	changeSignal;
+	bool		pending;
+	bool		stopping;
+	bool		started;
+	std::thread	controlThread;
+	void	run		(void);
+	void	update		(std::vector<serviceDescriptor> &);
+
+	bool	sameParameters	(serviceRoute *, serviceDescriptor &);
+	void	addRoute	(serviceDescriptor &);
+	void	removeRoutes	(void);
+static	void	audioOut	(int16_t *, int, int, bool, void *);
+static	void	dataOut		(std::string, void *);
+static	void	bytesOut	(uint8_t *, int16_t, uint8_t, void *);
+static	void	programQuality	(int16_t, int16_t, int16_t, void *);
+static	void	motdata		(std::string, int, void *);
+};
+#endif
+
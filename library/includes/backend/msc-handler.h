@@ -39,8 +39,30 @@
 #include	"freq-interleaver.h"
 #include	"fft_handler.h"
 #include	"semaphore.h"
+#include	"backend-pool.h"
+#include	"cif-buffer.h"
+#include	"mot-sink.h"
+#include	"epg-decoder.h"
+#include	"ip-sink.h"
 
 class	virtualBackend;
+//
+//	A client of a subchannel - as registered by add_xxxChannel.
+//	Backends are shared: an audio backend by clients with the same
+//	callbacks, a data backend by all clients of the subchannel
+//	(the packets are dispatched to the streams on their address).
+//	The backend lives as long as there is a channel for it
+struct	mscChannel {
+	virtualBackend	*backend;
+	bool		isAudio;
+	int16_t		stream;		// data: the stream in the backend
+	audioOut_t	soundOut;
+	dataOut_t	dataOut;
+	programQuality_t quality;
+	motdata_t	motdata;
+	int16_t		audioFormat;	// see AUDIO_OUT_xxx
+	void		*ctx;
+};
 
 using namespace std;
 class mscHandler {
@@ -55,13 +77,41 @@ public:
 		~mscHandler		(void);
 	void	process_mscBlock	(std::complex<float> *, int16_t);
 	void	set_audioChannel	(audiodata	*);
+	void	set_audioChannel	(audiodata	*, int16_t);
 	void	set_dataChannel		(packetdata     *);
+	void	set_backendThreads	(int16_t);
+	void	setMotObjectHandler	(motObject_t, bool);
+	int32_t	getProgrammes		(uint32_t, int64_t, int64_t,
+	                                 epgProgramme_t, void *);
+	bool	exportEPG		(const std::string &);
+	bool	setIPSink		(const std::string &, int);
+	void	setIPTunnel		(int);
+//
+//	as set_xxxChannel, but with explicit callbacks and context,
+//	the channel is returned as handle for remove_channel
+	mscChannel	*add_audioChannel	(audiodata *,
+	                                         audioOut_t,
+	                                         dataOut_t,
+	                                         programQuality_t,
+	                                         motdata_t,
+	                                         int16_t,	// output format
+	                                         void *);
+	mscChannel	*add_dataChannel	(packetdata *,
+	                                         bytesOut_t,
+	                                         motdata_t,
+	                                         void *);
+	void	remove_channel		(mscChannel *);
+//	the frame counts of the handler of a data channel
+	void	getChannelStats		(mscChannel *, int32_t &, int32_t &);
 	void	reset			(void);
 	void	stop			(void);
 	void	start			(void);
+//	the CIF history - and the EPG - is to be cleared when changing
+//	the frequency
+	void	clearHistory		(void);
 private:
 virtual	void		run		(void);
-	void		process_mscBlock (std::vector<int16_t>, int16_t);
+	void		process_CIF	(void);
 	dabParams	params;
 	fft_handler	my_fftHandler;
 	std::complex<float>	*fft_buffer;
@@ -81,8 +131,22 @@ virtual	void		run		(void);
 	std::vector<complex<float> > phaseReference;
 	bool		audioService;
 	std::mutex	mutexer;
+	backendPool	*thePool;		// shared, see backendPool
+//	the programmes of the EPG objects among them
+	epgDecoder	theEPG;
+//	delivers the MOT objects completed by the backends
+	motSink		theMotSink;
+//	forwards the datagrams of the IP datacasting services
+	ipSink		theIPSink;
 	std::vector<virtualBackend *>theBackends;
-//	std::vector<int16_t> cifVector;
+	std::vector<mscChannel *>theChannels;
+	bool		isUsed		(virtualBackend *);
+	cifPool		cifs;
+	cifBuffer	*currentCif;
+//
+//	the last 16 CIFs of the multiplex, oldest first, used
+//	to prime the deinterleaver of a new backend
+	std::vector<cifBuffer *> cifHistory;
 	int16_t		cifCount;
 	int16_t		blkCount;
 	std::atomic<bool> work_to_do;
@@ -0,0 +1,57 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__RS_SUPERFRAME__
+#define	__RS_SUPERFRAME__
+
+#include	<stdint.h>
+#include	<vector>
+#include	"reed-solomon.h"
+//
+//	A DAB+ superframe consists of RSDims interleaved RS (120, 110)
+//	codewords, byte j + k * RSDims of the superframe being byte k
+//	of codeword j.
+//	The syndromes of all codewords are computed in a single pass
+//	over the (circular) frame buffer, while the payload is copied out.
+//	Only codewords with a non-zero syndrome - usually none of them -
+//	are handed over to the generic decoder.
+class	rsSuperframe {
+public:
+		rsSuperframe	(int16_t RSDims);
+		~rsSuperframe	(void);
+//	frame is a circular buffer of RSDims * 120 bytes, the superframe
+//	starting at "base", out receives the RSDims * 110 payload bytes.
+//	Returns -1 if one of the codewords could not be repaired,
+//	the number of corrected symbols otherwise
+	int16_t		decode		(const uint8_t *frame,
+	                                 int16_t base, uint8_t *out);
+private:
+	reedSolomon	genericDecoder;
+	int16_t		RSDims;
+//	mulTable [i][x] = x * alpha^i, in poly form
+	uint8_t		mulTable [10][256];
+	std::vector<uint8_t> syndromes;		// 10 * RSDims
+};
+
+#endif
+
@@ -0,0 +1,80 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__TIME_DEINTERLEAVER__
+#define	__TIME_DEINTERLEAVER__
+
+#include	"dab-constants.h"
+#include	<atomic>
+#include	<vector>
+#include	"semaphore.h"
+#include	"cif-buffer.h"
+//
+//	The time deinterleaver, shared by the audio and the data backend.
+//	It is at the same time the queue between the msc handler
+//	(the producer) and the thread of the backend (the consumer).
+//	The fragments are not copied: a row of the ring is a reference
+//	to the (shared) CIF buffer and the offset of the fragment in it.
+//	The 16 rows preceding the fragment being consumed are the
+//	history needed for the deinterleaving, the rows following
+//	it are the queue.
+#define	QUEUE_SIZE	20
+
+class	timeDeinterleaver {
+public:
+		timeDeinterleaver	(int16_t fragmentSize);
+		~timeDeinterleaver	(void);
+//
+//	producer side, the fragment is the one starting at "offset"
+//	in the CIF. Returns false if "running" went down while
+//	waiting for a free slot
+	bool	add			(cifBuffer *, int32_t offset,
+	                                 std::atomic<bool> &running);
+//
+//	prime - before the first add - fills the history with the
+//	given CIFs (oldest first, at most 16), a primed deinterleaver
+//	delivers output for the first fragments added
+	void	prime			(std::vector<cifBuffer *> &,
+	                                 int32_t offset);
+//
+//	consumer side, does not wait. Takes the next fragment - if any -
+//	and returns true if the output buffer now contains a
+//	deinterleaved fragment, i.e. not for the first 16 fragments
+	bool	fetch			(int8_t *);
+private:
+	int16_t		fragmentSize;
+	int16_t		nrRows;
+	struct fragmentRef {
+	   cifBuffer	*cif;
+	   int32_t	offset;
+	};
+	std::vector<fragmentRef> ring;
+	int16_t		nextIn;
+	int16_t		nextOut;
+	int16_t		countforInterleaver;
+	Semaphore	freeSlots;
+	Semaphore	usedSlots;
+};
+
+#endif
+
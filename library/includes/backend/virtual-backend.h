@@ -25,7 +25,11 @@
 
 #include	<stdint.h>
 #include	<stdio.h>
+#include	<atomic>
+#include	<vector>
 
+class	backendPool;
+class	cifBuffer;
 
 #define	CUSize	(4 * 16)
 
@@ -33,14 +37,35 @@ class	virtualBackend {
 public:
 		virtualBackend	(int16_t, int16_t);
 virtual		~virtualBackend	(void);
-virtual int32_t	process		(int16_t *, int16_t);
+//	the fragment is the "length" soft bits at "offset" in the CIF
+virtual int32_t	process		(cifBuffer *, int32_t offset, int16_t length);
 virtual void	stopRunning	(void);
 virtual	void	stop		(void);
+//	called by a worker of the backendPool, handles the pending fragments
+virtual	void	processPending	(void);
+//	fill the history of the time deinterleaver, see mscHandler
+virtual	void	primeHistory	(std::vector<cifBuffer *> &);
+//	true if the backend decodes the subchannel with these parameters
+virtual	bool	sameSubchannel	(int16_t startAddr, int16_t length,
+	                         bool shortForm, int16_t protLevel,
+	                         int16_t bitRate);
 	int16_t	startAddr	(void);
 	int16_t	Length		(void);
 protected:
 	int16_t startAddress;
 	int16_t	segmentLength;
+//
+//	pendingCount is the number of fragments waiting, a backend
+//	is scheduled when the count goes from 0 to 1, the worker
+//	handling it continues until the count is back at 0.
+//	Since there is never more than one worker busy with a
+//	backend, the fragments are processed in order.
+//	fragmentDone returns true while fragments are pending, the
+//	pool is told when the count reaches 0
+	std::atomic<int32_t>	pendingCount;
+	void	fragmentAdded	(backendPool *);
+	bool	fragmentDone	(backendPool *);
+	void	waitforIdle	(backendPool *);
 };
 #endif
 
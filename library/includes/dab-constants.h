@@ -117,6 +117,27 @@ float	im	= imag (z);
 	return re + im;
 }
 //
+//	The MSC soft bits are int8_t all the way from the msc handler,
+//	through the time deinterleaver, to the viterbi decoder.
+//	Saturation rules:
+//	- jan_abs (|re| + |im|) is never smaller than |re| or |im|,
+//	  so the ratio is in -1 .. 1, and the result in -127 .. 127;
+//	- the value is clamped anyway, and -128 is never produced, so
+//	  negating a soft bit (as the viterbi decoder does) cannot overflow;
+//	- a zero amplitude gives an erasure (0) rather than a NaN.
+static inline
+int8_t	softBit (float v, float ab) {
+float	res;
+	if (ab <= 0)
+	   return 0;
+	res	= v / ab * 127.0;
+	if (res > 127.0)
+	   return 127;
+	if (res < -127.0)
+	   return -127;
+	return (int8_t)res;
+}
+//
 
 //	These are defined elsewhere
 ////	for service handling we define
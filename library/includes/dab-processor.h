@@ -29,6 +29,8 @@
 #include	"dab-constants.h"
 #include	<thread>
 #include	<atomic>
+#include	<mutex>
+#include	<condition_variable>
 #include	<stdint.h>
 #include	<vector>
 #include	"dab-params.h"
@@ -36,11 +38,13 @@
 #include	"ofdm-decoder.h"
 #include	"fic-handler.h"
 #include	"msc-handler.h"
+#include	"full-ensemble.h"
+#include	"cache-writer.h"
 #include	"ringbuffer.h"
 #include	"dab-api.h"
 #include	"sample-reader.h"
-#ifdef	__TII_INCLUDED
-#include	"tii_detector.h"
+#ifdef	__TII_INCLUDED__
+#include	"tii_processor.h"
 #endif
 //
 class	deviceHandler;
@@ -66,6 +70,7 @@ public:
 	virtual ~dabProcessor	(void);
 	void	reset			(void);
 	void	stop			(void);
+	bool	retune			(void);
 	void	setOffset		(int32_t);
 	void	start			(void);
 	bool	signalSeemsGood		(void);
@@ -81,11 +86,26 @@ public:
 	                                             packetdata *, int16_t);
 	int32_t		get_SId			(std::string s);
 	std::string	get_serviceName		(int32_t);
+	uint32_t	get_ensembleChanges	(void);
+	int		getEnsemble		(ensembleComponent_t, void *);
 	void		set_audioChannel        (audiodata *);
+	void		set_audioChannel        (audiodata *, int16_t);
 	void		set_dataChannel         (packetdata *);
 	std::string	get_ensembleName        (void);
 	void		clearEnsemble           (void);
 	void		reset_msc		(void);
+	void		set_backendThreads	(int16_t);
+	void		startDecodeAll		(serviceCallbacks *, void *);
+	void		stopDecodeAll		(void);
+	int		getServiceStats		(serviceStats *, int);
+	void		setMotObjectHandler	(motObject_t, bool);
+	int32_t		getProgrammes		(uint32_t, int64_t, int64_t,
+	                                         epgProgramme_t, void *);
+	bool		exportEPG		(const std::string &);
+	bool		setIPSink		(const std::string &, int);
+	void		setIPTunnel		(int);
+	bool		setEnsembleCache	(const std::string &);
+	bool		preloadEnsemble		(int32_t);
 #ifdef	__TII_INCLUDED__
 //	additions for example-10
 	void            setTII_handler          (tii_t tii_Handler,
@@ -104,26 +124,34 @@ public:
         uint8_t         getInterTabId           (bool *);
 #endif
 private:
-//
-//	additions for example-10
-	int             tii_framedelay;
-        int             tii_counter;
-        tii_t           my_tiiHandler;
-        tii_ex_t        my_tiiExHandler;
-        float           tii_alfa;
-        int             tii_resetFrameCount;
-        unsigned        tii_num;
-
 	deviceHandler	*inputDevice;
 	dabParams	params;
 	sampleReader	myReader;
 	phaseReference	phaseSynchronizer;
+	ofdmDecoder	my_ofdmDecoder;
 #ifdef	__TII_INCLUDED__
-	TII_Detector	my_TII_Detector;
+//	additions for example-10, the detection has a thread of its own
+	tiiProcessor	my_tiiProcessor;
 #endif
-	ofdmDecoder	my_ofdmDecoder;
 	ficHandler	my_ficHandler;
 	mscHandler	my_mscHandler;
+	fullEnsembleHandler	fullEnsemble;
+//
+//	the warm start cache: the directory ("" for none) and the
+//	frequency - as told by preloadEnsemble - the ensemble is
+//	saved under. The files are written and removed by the cacheWriter,
+//	the other fields are for the processor thread only
+	cacheWriter		theCacheWriter;
+	std::mutex		cacheLocker;
+	std::string		cacheDirectory;
+	std::atomic<int32_t>	cacheFrequency;
+	int		cacheCheck;
+	int32_t		savedFrequency;
+	uint32_t	savedVersion;
+	uint32_t	lastVersion;
+	bool		cacheRemoved;
+	std::string	cacheName	(int32_t);
+	void		checkCache	(void);
 	syncsignal_t	syncsignalHandler;
 	systemdata_t	systemdataHandler;
 	programdata_t	programdataHandler;
@@ -131,6 +159,10 @@ private:
 	std::thread	threadHandle;
 	void		*userData;
 	std::atomic<bool>	running;
+	std::mutex		retuneLocker;
+	std::condition_variable	retuneDone;
+	bool			retuneAck;
+	void		retuneReset	(void);
 	bool		isSynced;
 	int		snr;
 	int32_t		T_null;
@@ -0,0 +1,65 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__CACHE_WRITER__
+#define	__CACHE_WRITER__
+
+#include	<stdint.h>
+#include	<string>
+#include	<deque>
+#include	<memory>
+#include	<thread>
+#include	<mutex>
+#include	<condition_variable>
+#include	"ensemble-db.h"
+
+//
+//	The cacheWriter - one per dabProcessor - writes and removes the
+//	warm start cache files on a thread of its own, so the processor
+//	thread never waits for the file system.
+//	The database handed over is a published snapshot, i.e. it does
+//	not change while being written.
+class	cacheWriter {
+public:
+		cacheWriter	(void);
+		~cacheWriter	(void);
+	void	save		(const std::string &, int32_t,
+	                         std::shared_ptr<const ensembleDB>);
+	void	remove		(const std::string &);
+private:
+	struct cacheJob {
+	   std::string		name;
+	   int32_t		frequency;
+	   std::shared_ptr<const ensembleDB> db;	// nullptr: remove
+	};
+	void		addJob		(cacheJob &);
+	void		run		(void);
+	std::mutex	locker;
+	std::condition_variable	jobAvailable;
+	std::deque<cacheJob>	jobs;
+	bool		stopping;
+	bool		started;
+	std::thread	threadHandle;
+};
+#endif
+
@@ -0,0 +1,187 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__ENSEMBLE_DB__
+#define	__ENSEMBLE_DB__
+#
+#include	<stdint.h>
+#include	<string>
+#include	<vector>
+#include	<map>
+#include	<unordered_map>
+#include	<complex>
+#include	"dab-api.h"
+#include	"tii_table.h"
+
+//	the database grows with the ensemble, these are just sanity
+//	limits against garbage that passed the crc
+#define	MAX_SERVICES	1024
+#define	MAX_COMPONENTS	1024
+
+	struct dablabel {
+	   std::string	label;
+	   bool		hasName;
+	   bool		fromCache;	// not (yet) seen in the FIC
+	};
+
+	typedef struct dablabel	dabLabel;
+
+	typedef struct subchannelmap channelMap;
+//	from FIG1/2
+	struct serviceid {
+	   uint32_t	serviceId;
+	   bool		confirmed;	// seen in the FIC, not just cached
+	   dabLabel	serviceLabel;
+	   bool		hasPNum;
+	   bool		hasLanguage;
+	   int16_t	language;
+	   int16_t	programType;
+	   uint16_t	pNum;
+	};
+
+	typedef	struct serviceid serviceId;
+//      The service component describes the actual service
+//      It really should be a union
+        struct servicecomponents {
+           int8_t       TMid;           // the transport mode
+           uint32_t     SId;            // belongs to the service
+           int16_t      componentNr;    // component
+
+           int16_t      ASCTy;          // used for audio
+           int16_t      PS_flag;        // use for both audio and packet
+           int16_t      subchannelId;   // used in both audio and packet
+           uint16_t     SCId;           // used in packet
+           uint8_t      CAflag;         // used in packet (or not at all)
+           int16_t      DSCTy;          // used in packet
+	   uint8_t	DGflag;		// used for TDC
+           int16_t      packetAddress;  // used in packet
+	   int16_t	appType;	// used in packet
+	   bool		is_madePublic;
+	   bool		confirmed;
+        };
+
+        typedef struct servicecomponents serviceComponent;
+
+//	for the "decode all" mode, a description of each of the
+//	service components - audio or packet - that can be decoded
+	struct serviceDescriptor {
+	   int32_t	SId;
+	   bool		isAudio;
+	   int16_t	componentNr;
+	   audiodata	ad;
+	   packetdata	pd;
+	};
+
+	struct subchannelmap {
+	   bool		inUse;
+	   int32_t	SubChId;
+	   int32_t	StartAddr;
+	   int32_t	Length;
+	   bool		shortForm;
+	   int32_t	protLevel;
+	   int32_t	BitRate;
+	   int16_t	language;
+	   int16_t	FEC_scheme;
+	   bool		confirmed;
+	};
+
+//
+//	The ensemble database: services and components are kept in
+//	vectors, indexed by SId, by (SId, component number), by SCId
+//	and by label. Subchannels are indexed by their (6 bit) SubChId.
+//	Entries are only removed by clearing or pruning, both rebuild
+//	the indices.
+//	The fib_processor maintains one, and publishes copies of it
+//	as immutable snapshots - by swapping a shared pointer - each
+//	time it changes, the const queries are answered from such a
+//	snapshot without waiting for the thread processing the FIC.
+class	ensembleDB {
+public:
+		ensembleDB		(void);
+		~ensembleDB		(void);
+	void	clear			(void);
+	void	clearComponents		(void);
+//
+//	maintenance, for the fib_processor. The pointers returned
+//	are valid until the next add
+	serviceId	*findService	(uint32_t);
+	serviceId	*addService	(uint32_t);	// find or create
+	void		setLabel	(serviceId *, const std::string &);
+	serviceComponent *findComponent	(uint32_t SId, int16_t compNr);
+	serviceComponent *findPacketComponent	(uint16_t SCId);
+	serviceComponent *addComponent	(const serviceComponent &);
+	int32_t		nrServices	(void) const;
+	int32_t		nrComponents	(void) const;
+//
+//	the warm start cache: a compact file per frequency. Loaded
+//	entries are marked "not confirmed", prune removes those that
+//	were not confirmed by the FIC
+	bool		save		(const std::string &,
+	                                 int32_t frequency) const;
+	bool		load		(const std::string &,
+	                                 int32_t frequency);
+	bool		hasUnconfirmed	(void) const;
+	void		prune		(void);
+//
+//	queries
+	std::string nameFor		(int32_t) const;
+	int32_t	SIdFor			(const std::string &) const;
+	uint8_t	kindofService		(const std::string &) const;
+	void	dataforAudioService	(const std::string &,
+	                                 audiodata *, int16_t) const;
+	void	dataforDataService	(const std::string &,
+	                                 packetdata *, int16_t) const;
+	void	get_serviceList		(std::vector<serviceDescriptor> &) const;
+	int32_t	enumerate		(ensembleComponent_t, void *) const;
+	std::complex<float>
+		get_coordinates		(int16_t, int16_t, bool *) const;
+	std::complex<float>
+		get_coordinates		(int16_t, int16_t, bool *,
+	                                 int16_t *pMainId,
+	                                 int16_t *pSubId,
+	                                 int16_t *pTD) const;
+
+	uint32_t	version;	// the change count of a snapshot
+	int32_t		EId;		// -1 if not known
+	channelMap	subChannels	[64];
+	tii_table	coordinates;
+private:
+	std::vector<serviceId>		services;
+	std::vector<serviceComponent>	components;
+	std::unordered_map<uint32_t, int32_t>	bySId;
+	std::unordered_map<uint64_t, int32_t>	byComponent;
+	std::unordered_map<uint16_t, int32_t>	bySCId;
+	std::map<std::string, int32_t>		byLabel;
+	const serviceId	*findService	(uint32_t) const;
+	const serviceId	*findService	(const std::string &) const;
+	const serviceComponent	*findComponent	(uint32_t, int16_t) const;
+	void		reindex		(void);
+	bool		describe	(const serviceComponent *,
+	                                 serviceDescriptor *) const;
+	void		fillAudiodata	(const serviceComponent *,
+	                                 const serviceId *, audiodata *) const;
+	void		fillPacketdata	(const serviceComponent *,
+	                                 packetdata *) const;
+};
+
+#endif
@@ -27,67 +27,20 @@
 #include	<stdint.h>
 #include	<stdio.h>
 #include	<string>
+#include	<vector>
 #include	<mutex>
 #include	<atomic>
 #include	"dab-api.h"
 #include	"dab-constants.h"
+#include	<memory>
 #include	"tii_table.h"
+#include	"ensemble-db.h"
 
-	struct dablabel {
-	   std::string	label;
-	   bool		hasName;
-	};
-
-	typedef struct dablabel	dabLabel;
-
-	typedef struct subchannelmap channelMap;
-//	from FIG1/2
-	struct serviceid {
-	   bool		inUse;
-	   uint32_t	serviceId;
-	   dabLabel	serviceLabel;
-	   bool		hasPNum;
-	   bool		hasLanguage;
-	   int16_t	language;
-	   int16_t	programType;
-	   uint16_t	pNum;
-	};
-
-	typedef	struct serviceid serviceId;
-//      The service component describes the actual service
-//      It really should be a union
-        struct servicecomponents {
-           bool         inUse;          // just administration
-           int8_t       TMid;           // the transport mode
-           serviceId    *service;       // belongs to the service
-           int16_t      componentNr;    // component
-
-           int16_t      ASCTy;          // used for audio
-           int16_t      PS_flag;        // use for both audio and packet
-           int16_t      subchannelId;   // used in both audio and packet
-           uint16_t     SCId;           // used in packet
-           uint8_t      CAflag;         // used in packet (or not at all)
-           int16_t      DSCTy;          // used in packet
-	   uint8_t	DGflag;		// used for TDC
-           int16_t      packetAddress;  // used in packet
-	   int16_t	appType;	// used in packet
-	   bool		is_madePublic;
-        };
-
-        typedef struct servicecomponents serviceComponent;
-
-	struct subchannelmap {
-	   bool		inUse;
-	   int32_t	SubChId;
-	   int32_t	StartAddr;
-	   int32_t	Length;
-	   bool		shortForm;
-	   int32_t	protLevel;
-	   int32_t	BitRate;
-	   int16_t	language;
-	   int16_t	FEC_scheme;
-	};
-
+//	number of entries in the FIG cache, must be a power of 2
+#define	FIG_CACHE_SIZE	1024
+//	the number of FIBs - some 10 seconds in Mode 1 - the FIC has to
+//	confirm the entries of a database preloaded from the cache
+#define	WARM_START_FIBS	1250
 
 class	fib_processor {
 public:
@@ -107,6 +60,8 @@ public:
 	void	dataforDataService	(std::string &, packetdata *);
 	void	dataforAudioService	(std::string &, audiodata *, int16_t);
 	void	dataforDataService	(std::string &, packetdata *, int16_t);
+	void	get_serviceList		(std::vector<serviceDescriptor> &);
+	int32_t	enumerate		(ensembleComponent_t, void *);
 
         std::complex<float>
                 get_coordinates (int16_t, int16_t, bool *);
@@ -125,6 +80,21 @@ public:
                                      int16_t *pTD);
         uint8_t getECC                  (bool *);
         uint8_t getInterTabId           (bool *);
+//
+//	incremented on each change in the ensemble database
+	uint32_t get_changeCount	(void) const;
+//
+//	the most recently published copy of the database, the queries
+//	above are answered from it, without locking
+	std::shared_ptr<const ensembleDB>
+		get_snapshot		(void) const;
+//
+//	the warm start cache, the database itself does the file handling.
+//	ensembleToSave gives nullptr when the database is not worth saving
+	void	preload			(std::shared_ptr<const ensembleDB>);
+	std::shared_ptr<const ensembleDB>
+		ensembleToSave		(void);
+	bool	cacheIsStale		(void);
 
 private:
 	ensemblename_t	ensemblenameHandler;
@@ -133,7 +103,6 @@ private:
 	serviceId	*findServiceId (int32_t);
 	serviceComponent *find_packetComponent (int16_t);
 	serviceComponent *find_serviceComponent (int32_t SId, int16_t SCId);
-	serviceId	*findServiceId	(std::string);
         void            bind_audioService (int8_t,
                                            uint32_t, int16_t,
                                            int16_t, int16_t, int16_t);
@@ -182,10 +151,7 @@ private:
 	                                         int16_t, uint8_t);
 	int16_t		HandleFIG0Extension22	(uint8_t *, int16_t);
 	int32_t		dateTime	[8];
-	channelMap	subChannels [64];
-	serviceComponent	ServiceComps [64];
-	serviceId	listofServices [64];
-	tii_table	coordinates;
+	ensembleDB	db;
         bool            dateFlag;
 //
 //	additional data for ex-10 functions
@@ -200,6 +166,37 @@ private:
 	bool		isSynced;
 	mutex		fibLocker;
 //
+//	Most FIGs are repeated unchanged, over and over again. The cache
+//	holds the hashes of the FIGs processed so far, a FIG seen before
+//	- while the database did not change since - is skipped.
+//	An entry is only valid while its "generation" equals the
+//	changeCount, so any change in the database invalidates all
+//	entries at once (a FIG that had no effect earlier may have
+//	one now, e.g. a FIG0/2 arriving before the service label).
+	struct figCacheEntry {
+	   uint64_t	hash;
+	   uint32_t	generation;
+	};
+	figCacheEntry	figCache [FIG_CACHE_SIZE];
+	std::atomic<uint32_t>	changeCount;
+	bool		cacheable	(uint8_t);
+	uint64_t	figHash		(const uint8_t *, int16_t);
+	bool		figSeen		(uint64_t);
+	void		figRemember	(uint64_t);
+	void		databaseChanged	(void);
+//
+//	the published snapshot, only accessed with std::atomic_load
+//	and std::atomic_store
+	std::shared_ptr<const ensembleDB> snapshot;
+	void		publish		(void);
+//
+//	the database preloaded from the cache, until the first FIG0/0,
+//	and the number of FIBs left to confirm its entries
+	std::shared_ptr<const ensembleDB> warmDB;
+	std::atomic<int32_t>	warmFIBs;
+	std::atomic<bool>	cacheStale;
+	void		applyWarmDB	(void);
+//
 //	these were signals
 	void		addtoEnsemble	(const std::string &, int32_t);
 	void		nameofEnsemble  (int, const std::string &);
@@ -44,15 +44,22 @@ public:
 	                                 fib_quality_t,
 	                                 void	*);
 		~ficHandler		(void);
-	void	process_ficBlock	(std::vector<int16_t>, int16_t);
+	void	process_ficBlock	(const int16_t *, int16_t);
 	void	clearEnsemble		(void);
 	bool	syncReached		(void);
 	int16_t	get_ficRatio		(void);
 	std::string nameFor		(int32_t);
 	int32_t	SIdFor			(std::string &);
+	uint32_t get_changeCount	(void) const;
 	uint8_t	kindofService		(std::string &);
 	void	dataforDataService	(std::string &, packetdata *, int);
 	void	dataforAudioService	(std::string &, audiodata *, int);
+	void	get_serviceList		(std::vector<serviceDescriptor> &);
+	int32_t	enumerate		(ensembleComponent_t, void *);
+	void	preload			(std::shared_ptr<const ensembleDB>);
+	std::shared_ptr<const ensembleDB>
+		ensembleToSave		(void);
+	bool	cacheIsStale		(void);
 //
 //	additional functions for example 10
         int32_t get_CIFcount            (void) const;
@@ -88,6 +95,8 @@ private:
 	uint8_t		PRBS [768];
 	uint8_t		shiftRegister [9];
 	void		show_ficCRC	(bool);
+	int		ficCRC_ok;
+	int		ficCRC_count;
 };
 
 #endif
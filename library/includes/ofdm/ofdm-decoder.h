@@ -53,6 +53,7 @@ private:
 	int32_t		nrBlocks;
 	int16_t		getMiddle	(void);
 	std::vector <complex<float> >	phaseReference;
+	std::vector <complex<float> >	conjVector;
 	std::complex<float>	*fft_buffer;
 	int32_t		blockIndex;
 };
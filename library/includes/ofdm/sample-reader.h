@@ -44,6 +44,8 @@ public:
 
 			~sampleReader		(void);
 		void	setRunning	(bool b);
+//	while set, the reader throws (22) rather than waiting for samples
+		void	setRetune	(bool b);
 		float	get_sLevel	(void);
 	        void	reset		(void);
 		std::complex<float> getSample	(int32_t);
@@ -59,6 +61,7 @@ private:
 		int32_t		currentPhase;
 		std::complex<float>	*oscillatorTable;
 		std::atomic<bool>	running;
+		std::atomic<bool>	retuning;
 		int32_t		bufferContent;
 		float		sLevel;
 		int32_t		sampleCount;
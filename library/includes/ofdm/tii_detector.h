@@ -33,7 +33,7 @@ public:
 		TII_Detector	(uint8_t dabMode);
 		~TII_Detector	(void);
 	void	reset		(void);
-	void	addBuffer	(std::vector<std::complex<float>>,
+	void	addBuffer	(const std::complex<float> *,
 	                         float alfa = -1.0F,
 	                         int32_t cifCounter =-1);
 inline	uint16_t getNumBuffers	(void) const { return numUsedBuffers; }
@@ -58,7 +58,6 @@ private:
 public:
 	float		P_allAvg  [2048];
 private:
-	float		P_tmpNorm [2048];
 	float		P_avg     [384];	// 8 groups per 24*2 carriers = 384 carriers
 
 	bool		isFirstAdd;
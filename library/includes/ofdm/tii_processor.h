@@ -0,0 +1,81 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__TII_PROCESSOR__
+#define	__TII_PROCESSOR__
+
+#include	<stdint.h>
+#include	<complex>
+#include	<thread>
+#include	<mutex>
+#include	<atomic>
+#include	"dab-constants.h"
+#include	"dab-api.h"
+#include	"ringbuffer.h"
+#include	"semaphore.h"
+#include	"tii_detector.h"
+
+//	the number of null periods that can be queued
+#define	TII_QUEUE_SIZE	8
+//
+//	The TII detection - an FFT per null period, and every
+//	"framedelay" null periods the analysis - is done by a thread
+//	of its own, the thread processing the samples only copies the
+//	null period into a (lock free) ringbuffer.
+//	If the tii thread falls behind, null periods are dropped rather
+//	than delaying the demodulation.
+//	The handlers are called from the tii thread.
+class	tiiProcessor {
+public:
+		tiiProcessor	(uint8_t dabMode, void *userData);
+		~tiiProcessor	(void);
+	void	setHandlers	(tii_t, tii_ex_t,
+	                         int framedelay,
+	                         float alfa, int resetFrameCount);
+	bool	isActive	(void);
+	void	addBuffer	(const std::complex<float> *);
+	void	reset		(void);
+private:
+	void		run		(void);
+	TII_Detector	theDetector;
+	int16_t		T_u;
+	void		*userData;
+	RingBuffer<std::complex<float>> nullPeriods;
+	Semaphore	usedSlots;
+	std::atomic<bool>	running;
+	std::atomic<bool>	resetRequest;
+	std::atomic<bool>	active;
+	std::thread	threadHandle;
+//
+//	the settings, as passed by setHandlers
+	std::mutex	locker;
+	tii_t		tiiHandler;
+	tii_ex_t	tiiExHandler;
+	int		framedelay;
+	float		alfa;
+	int		resetFrameCount;
+	int		counter;
+};
+
+#endif
+
@@ -0,0 +1,49 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#ifndef	__CRC_HANDLER__
+#define	__CRC_HANDLER__
+
+#include	<stdint.h>
+//
+//	The CRC used in DAB for FIB's, packet mode packets, MSC data groups,
+//	DAB+ AU's and X-PAD data groups is the 16 bit CCITT one,
+//	G (x) = x^16 + x^12 + x^5 + 1, register preset to all ones,
+//	and the transmitted crc is the one's complement of the register.
+//
+//	The functions below are table driven (slice-by-8) and - unlike
+//	check_CRC_bits in dab-constants.h - do NOT touch the input.
+
+//	crc register after processing "len" bytes, starting with "init"
+uint16_t	crc16_bytes	(const uint8_t *msg, int32_t len,
+	                         uint16_t init = 0xFFFF);
+//
+//	msg [0 .. len - 1] is the message, msg [len], msg [len + 1]
+//	contain the (inverted) crc
+bool		check_crc16_bytes	(const uint8_t *msg, int32_t len);
+//
+//	in [0 .. size - 1] is a sequence of bits, one bit per byte,
+//	the last 16 of which are the (inverted) crc
+bool		check_crc16_bits	(const uint8_t *in, int32_t size);
+#endif
+
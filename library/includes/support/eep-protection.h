@@ -32,7 +32,7 @@
 public:
 		eep_protection		(int16_t, int16_t);
 		~eep_protection		(void);
-bool		deconvolve		(int16_t *, int32_t, uint8_t *);
+bool		deconvolve		(int8_t *, int32_t, uint8_t *);
 };
 
 #endif
@@ -33,12 +33,12 @@ class	protection: public viterbiHandler {
 public:
 		protection  	(int16_t, int16_t);
 virtual		~protection	(void);
-virtual	bool	deconvolve	(int16_t *, int32_t, uint8_t *);
+virtual	bool	deconvolve	(int8_t *, int32_t, uint8_t *);
 protected:
         int16_t         bitRate;
         int32_t         outSize;
         std::vector<uint8_t> indexTable;
-        std::vector<int16_t> viterbiBlock;
+        std::vector<int8_t> viterbiBlock;
 };
 #endif
 
@@ -20,6 +20,8 @@
  *    along with Qt-DAB; if not, write to the Free Software
  *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
+#ifndef	__TII_TABLE__
+#define	__TII_TABLE__
 #include	"dab-constants.h"
 #include	<vector>
 
@@ -39,20 +41,21 @@ public:
 		tii_table		(void);
 		~tii_table		(void);
 	void	cleanUp			(void);
-	void	add_element		(tii_element *);
-	void	add_main		(int16_t, float, float);
+//	both return true when the table changed
+	bool	add_element		(tii_element *);
+	bool	add_main		(int16_t, float, float);
 	std::complex<float>		get_coordinates (int16_t,
-	                                                 int16_t, bool *);
+	                                                 int16_t, bool *) const;
 	std::complex<float>		get_coordinates (int16_t, int16_t,
 	                                                 bool *,
 	                                                 int16_t *pMainId,
 	                                                 int16_t *pSubId,
-	                                                 int16_t *pTD);
+	                                                 int16_t *pTD) const;
 
-	void	print_coordinates	(void);
+	void	print_coordinates	(void) const;
 	int16_t	mainId;
 	float	latitude;
 	float	longitude;
 	std::vector<tii_element> offsets;
 };
-
+#endif
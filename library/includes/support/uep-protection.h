@@ -31,7 +31,7 @@
 public:
 		uep_protection (int16_t, int16_t);
 		~uep_protection	(void);
-bool		deconvolve	(int16_t *, int32_t, uint8_t *);
+bool		deconvolve	(int8_t *, int32_t, uint8_t *);
 };
 
 #endif
@@ -32,8 +32,16 @@ public:
 		viterbiHandler	(int);
 		~viterbiHandler	(void);
 	void	deconvolve	(int16_t *, uint8_t *);
+	void	deconvolve	(int8_t *, uint8_t *);
 private:
+template <typename softBit>
+	void	decodeBlock	(const softBit *, uint8_t *);
 	int     costTable [16];
+//	tables for the 64 (K = 7) states, per instance - they are
+//	filled by the constructor - so decoders do not share state
+	int	predecessor_for_0 [64];
+	int	predecessor_for_1 [64];
+	int16_t	indexTable [2 * 64];
 	void	computeCostTable (int16_t,  int16_t, int16_t, int16_t);
 	uint8_t	bitFor		(int, int, int);
 	int	blockLength;
@@ -29,12 +29,13 @@
 #include	"uep-protection.h"
 #include	<chrono>
 //
-//	As an experiment a version of the backend is created
-//	that will be running in a separate thread. Might be
-//	useful for multicore processors.
+//	The backend does not have a thread of its own, the
+//	fragments are handled by a worker of the backendPool
+//	shared by all backends.
 //
-//	Interleaving is - for reasons of simplicity - done
-//	inline rather than through a special class-object
+//	The time deinterleaving - and the queueing of the fragments
+//	for the thread - is done by the timeDeinterleaver, shared
+//	with the data backend
 //
 //	fragmentsize == Length * CUSize
 	audioBackend::audioBackend	(audiodata	*d,
@@ -42,28 +43,23 @@
 	                                 dataOut_t	dataOut,
 	                                 programQuality_t mscQuality,
 	                                 motdata_t	motdata_Handler,
+	                                 motSink	*theSink,
+	                                 int16_t	outputFormat,
+	                                 backendPool	*thePool,
 	                                 void		*ctx):
 	                                     virtualBackend (d -> startAddr,
 	                                                     d -> length),
 	                                     outV (24 * d -> bitRate),
-	                                     freeSlots (20) {
+	                                     deInterleaver (d -> length * CUSize) {
 int32_t i, j;
 
+	this	-> thePool		= thePool;
 	this    -> dabModus             = d -> ASCTy == 077 ? DAB_PLUS : DAB;
 	this    -> fragmentSize         = d -> length * CUSize;
 	this	-> bitRate		= d -> bitRate;
 	this	-> shortForm		= d -> shortForm;
 	this	-> protLevel		= d -> protLevel;
 
-	interleaveData		= new int16_t *[16]; // max size
-	for (i = 0; i < 16; i ++) {
-	   interleaveData [i] = new int16_t [fragmentSize];
-	   memset (interleaveData [i], 0, fragmentSize * sizeof (int16_t));
-	}
-
-	interleaverIndex	= 0;
-	countforInterleaver	= 0;
-
 	if (shortForm)
 	   protectionHandler	= new uep_protection (bitRate,
 	                                              protLevel);
@@ -78,23 +74,23 @@ int32_t i, j;
 	                                        soundOut,
 	                                        dataOut,
 	                                        mscQuality,
-	                                        motdata_Handler, ctx);
+	                                        motdata_Handler,
+	                                        theSink,
+	                                        outputFormat, ctx);
 	else
 	if (dabModus == DAB_PLUS) 
 	   our_backendBase = new mp4Processor (bitRate,
 	                                        soundOut,
 	                                        dataOut,
 	                                        mscQuality,
-	                                        motdata_Handler, ctx);
+	                                        motdata_Handler,
+	                                        theSink,
+	                                        outputFormat, ctx);
 	else		// cannot happen
 	   our_backendBase = new backendBase ();
 
 	fprintf (stderr, "we have now %s\n", dabModus == DAB_PLUS ? "DAB+" : "DAB");
 	tempX . resize (fragmentSize);
-	nextIn			= 0;
-	nextOut			= 0;
-	for (i = 0; i < 20; i ++)
-	   theData [i] = new int16_t [fragmentSize];
 
 	uint8_t	shiftRegister [9];
 	disperseVector. resize (bitRate * 24);
@@ -111,84 +107,62 @@ int32_t i, j;
 }
 
 	audioBackend::~audioBackend	(void) {
-int16_t	i;
-	if (running. load ()) {
-	   running. store (false);
-	   threadHandle. join ();
-	}
+	stopRunning ();
 	delete protectionHandler;
 	delete our_backendBase;
-	for (i = 0; i < 16; i ++) 
-	   delete[]  interleaveData [i];
-	delete [] interleaveData;
-
-	for (i = 0; i < 20; i ++)
-	   delete [] theData [i];
-
 }
 
 void	audioBackend::start		(void) {
 	running. store (true);
-	threadHandle = std::thread (&audioBackend::run, this);
 }
 
-int32_t	audioBackend::process	(int16_t *v, int16_t cnt) {
-	while (!freeSlots. tryAcquire (200))
-	   if (!running. load ())
-	      return 0;
-	memcpy (theData [nextIn], v, fragmentSize * sizeof (int16_t));
-	nextIn = (nextIn + 1) % 20;
-	usedSlots. Release ();
-	return 1;
+void	audioBackend::primeHistory	(std::vector<cifBuffer *> &h) {
+	deInterleaver. prime (h, startAddress * CUSize);
 }
 
-const	int16_t interleaveMap [] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
-void    audioBackend::processSegment (int16_t *Data) {
-int16_t i;
-
-        for (i = 0; i < fragmentSize; i ++) {
-           tempX [i] = interleaveData [(interleaverIndex +
-                                        interleaveMap [i & 017]) & 017][i];
-           interleaveData [interleaverIndex][i] = Data [i];
-        }
-
-        interleaverIndex = (interleaverIndex + 1) & 0x0F;
-        nextOut = (nextOut + 1) % 20;
-        freeSlots. Release ();
-
-//      only continue when de-interleaver is filled
-        if (countforInterleaver <= 15) {
-           countforInterleaver ++;
-           return;
-        }
-
-	protectionHandler -> deconvolve (tempX. data (),
-	                                 fragmentSize,
-	                                  outV. data ());
-//
-//      and the energy dispersal
-	for (i = 0; i < bitRate * 24; i ++)
-	   outV [i] ^= disperseVector [i];
+bool	audioBackend::sameSubchannel	(int16_t startAddr, int16_t length,
+	                                 bool shortForm, int16_t protLevel,
+	                                 int16_t bitRate) {
+	return (startAddr	== this -> startAddress) &&
+	       (length		== this -> segmentLength) &&
+	       (shortForm	== this -> shortForm) &&
+	       (protLevel	== this -> protLevel) &&
+	       (bitRate		== this -> bitRate);
+}
 
-	our_backendBase -> addtoFrame (outV. data ());
+int32_t	audioBackend::process	(cifBuffer *cif,
+	                         int32_t offset, int16_t cnt) {
+	(void)cnt;
+	if (!deInterleaver. add (cif, offset, running))
+	   return 0;
+	fragmentAdded (thePool);
+	return 1;
 }
+//
+//	executed by a worker of the pool
+void    audioBackend::processPending	(void) {
+int16_t	i;
+
+	do {
+	   if (!deInterleaver. fetch (tempX. data ()) || !running. load ())
+	      continue;
 
-void    audioBackend::run       (void) {
+	   protectionHandler -> deconvolve (tempX. data (),
+	                                    fragmentSize,
+	                                    outV. data ());
+//
+//	and the energy dispersal
+	   for (i = 0; i < bitRate * 24; i ++)
+	      outV [i] ^= disperseVector [i];
 
-        while (running. load ()) {
-           while (!usedSlots. tryAcquire (200))
-              if (!running. load ())
-                 return;
-           processSegment (theData [nextOut]);
-        }
+	   our_backendBase -> addtoFrame (outV. data ());
+	} while (fragmentDone (thePool));
 }
 
 //
 //	It might take a msec for the task to stop
 void	audioBackend::stopRunning (void) {
-	if (running. load ()) {
-	   running. store (false);
-	   threadHandle. join ();
-	}
+	running. store (false);
+	waitforIdle (thePool);
 }
 
@@ -222,14 +222,17 @@ struct quantizer_spec quantizer_table [17] = {
 	                            dataOut_t		dataOut,
 	                            programQuality_t	mscQuality,
 	                            motdata_t		motdata_Handler,
+	                            motSink		*theSink,
+	                            int16_t		outputFormat,
 	                            void		*ctx):
 	                                       my_padHandler (dataOut,
-	                                                      motdata_Handler,
+	                                                      motdata_Handler, theSink,
 	                                                      ctx) {
 int16_t	i, j;
 int16_t *nPtr = &N [0][0];
 
 	this	-> ctx	= ctx;
+	this	-> outputFormat	= outputFormat;
 	// compute N[i][j]
 	for (i = 0;  i < 64;  i ++)
 	   for (j = 0;  j < 32;  ++j)
@@ -603,16 +606,18 @@ int16_t vLength = 24 * bitRate / 8;
 	      if (MP2bitCount >= lf) {
 	         bool stereo;
 	         int16_t sample_buf [KJMP2_SAMPLES_PER_FRAME * 2];
-#ifdef	AAC_OUT
-	         soundOut ((int16_t *)(&MP2frame [0]), MP2bitCount,
-	                               0, false, nullptr);
-#else
+//	any format other than PCM: the frame (bytes) as it is
+	         if (outputFormat != AUDIO_OUT_PCM) {
+	            if (soundOut != nullptr)
+	               soundOut ((int16_t *)(&MP2frame [0]), MP2bitCount / 8,
+	                                     0, (MP2frame [3] >> 6) != 3, ctx);
+	         }
+	         else
 	         if (mp2decodeFrame (MP2frame, sample_buf, &stereo)) {
 	            output (sample_buf,
 	                    2 * (int32_t)KJMP2_SAMPLES_PER_FRAME,
 	                    baudRate, stereo);
 	         }
-#endif
 
 	         MP2Header_OK = 0;
 	         MP2headerCount = 0;
@@ -50,6 +50,7 @@
 //
 #include	"charsets.h"
 #include	"pad-handler.h"
+#include	"crc-handler.h"
 
 #include	<stdlib.h>
 #include	<stdint.h>
@@ -112,26 +113,32 @@ void	WriteAudioMuxLengthBytes () {
 	                            dataOut_t		dataOut,
 	                            programQuality_t	mscQuality,
 	                            motdata_t		motdata_Handler,
+	                            motSink		*theSink,
+	                            int16_t		outputFormat,
 	                            void		*ctx):
 	                                  my_padHandler (dataOut,
-	                                                 motdata_Handler,
+	                                                 motdata_Handler, theSink,
 	                                                 ctx),
-	                                  my_rsDecoder (8, 0435, 0, 1, 10),
-	                                  aacDecoder (soundOut, ctx) {
+	                                  my_rsDecoder (bitRate / 8) {
 
 	this	-> bitRate	= bitRate;	// input rate
 	this	-> soundOut	= soundOut;
 	this	-> mscQuality	= mscQuality;	//
 	this	-> ctx		= ctx;
+	this	-> outputFormat	= outputFormat;
+	if (outputFormat == AUDIO_OUT_PCM)
+	   aacDecoder	= new faadDecoder (soundOut, ctx);
+	else
+	   aacDecoder	= nullptr;
 	superFramesize		= 110 * (bitRate / 8);
 	RSDims			= bitRate / 8;
 	frameBytes. resize (RSDims * 120);	// input
 	outVector.  resize (RSDims * 110);
 	blockFillIndex	= 0;
 	blocksInBuffer	= 0;
-
-	blockFillIndex	= 0;
-	blocksInBuffer	= 0;
+	inSync		= false;
+	for (int i = 0; i < 5; i ++)
+	   fireCodeOK [i] = false;
 	frameCount      = 0;
         frameErrors     = 0;
         aacErrors       = 0;
@@ -145,80 +152,89 @@ void	WriteAudioMuxLengthBytes () {
 }
 
 	mp4Processor::~mp4Processor (void) {
+	if (aacDecoder != nullptr)
+	   delete aacDecoder;
 }
 //
-//	we add vector for vector to the superframe. Once we have
-//	5 lengths of "old" frames, we check
+//	we add vector for vector to the superframe, frameBytes is a
+//	ring of 5 packed blocks. Each block is packed once, on arrival,
+//	and the fire code of a block - the block being a candidate
+//	start of a superframe - is checked once, on arrival, as well.
+//	Once we have 5 blocks following a candidate start, we
+//	give the superframe a try.
+//	When in sync, a superframe is expected every 5 blocks, a single
+//	failing superframe does not make us lose the alignment, so after
+//	a short dropout decoding continues with the next superframe.
 void	mp4Processor::addtoFrame (uint8_t *V) {
-int16_t	i, j;
-uint8_t	temp	= 0;
-int16_t	nbits	= 24 * bitRate;
+int16_t	i;
+int16_t	nbytes	= 24 * bitRate / 8;
+uint8_t	*block	= &frameBytes [blockFillIndex * nbytes];
 //
 //	Note that the packing in the entry vector is still one bit
-//	per Byte, nbits is the number of Bits (i.e. containing bytes)
-	for (i = 0; i < nbits / 8; i ++) {	// in bytes
-	   temp = 0;
-	   for (j = 0; j < 8; j ++)
-	      temp = (temp << 1) | (V [i * 8 + j] & 01);
-	   frameBytes [blockFillIndex * nbits / 8 + i] = temp;
+//	per Byte
+	for (i = 0; i < nbytes; i ++) {	// in bytes
+	   const uint8_t *b = &V [8 * i];
+	   block [i] = ((b [0] & 01) << 7) | ((b [1] & 01) << 6) |
+	               ((b [2] & 01) << 5) | ((b [3] & 01) << 4) |
+	               ((b [4] & 01) << 3) | ((b [5] & 01) << 2) |
+	               ((b [6] & 01) << 1) | (b [7] & 01);
 	}
+	fireCodeOK [blockFillIndex] = fc. check (block);
 //
 	blocksInBuffer ++;
 	blockFillIndex = (blockFillIndex + 1) % 5;
 //
 //	we take the last five blocks to look at
-	if (blocksInBuffer >= 5) {
-	   if (++frameCount >= 50) {
-	      frameCount = 0;
-	      frame_quality	= 2 * (50 - frameErrors);
-	      if (mscQuality != nullptr)
-	         mscQuality (frame_quality, rs_quality, aac_quality, ctx);
-	      frameErrors = 0;
-	   }
+	if (blocksInBuffer < 5)
+	   return;
+
+	if (++frameCount >= 50) {
+	   frameCount = 0;
+	   frame_quality	= 2 * (50 - frameErrors);
+	   if (mscQuality != nullptr)
+	      mscQuality (frame_quality, rs_quality, aac_quality, ctx);
+	   frameErrors = 0;
+	}
 
-//	OK, we give it a try, check the fire code
-	   if (fc. check (&frameBytes [blockFillIndex * nbits / 8]) &&
-	       (processSuperframe (frameBytes. data (),
-	                           blockFillIndex * nbits / 8))) {
+//	OK, we give it a try, the fire code was already checked
+	if (fireCodeOK [blockFillIndex] &&
+	       processSuperframe (frameBytes. data (),
+	                          blockFillIndex * nbytes)) {
 //	since we processed a full cycle of 5 blocks, we just start a
 //	new sequence, beginning with block blockFillIndex
-	      blocksInBuffer	= 0;
-	      if (++successFrames > 25) {
-	         rs_quality	= 4 * (25 - rsErrors);
-                 successFrames  = 0;
-                 rsErrors       = 0;
-              }
-	   }
-	   else {	// virtual shift to left in block sizes
-	      blocksInBuffer  = 4;
-	      frameErrors ++;
+	   blocksInBuffer	= 0;
+	   inSync		= true;
+	   if (++successFrames > 25) {
+	      rs_quality	= 4 * (25 - rsErrors);
+	      successFrames  = 0;
+	      rsErrors       = 0;
 	   }
+	   return;
 	}
+
+	frameErrors ++;
+	if (inSync) {		// keep the alignment, wait for the next
+	   inSync		= false;
+	   blocksInBuffer	= 0;
+	}
+	else			// virtual shift to left in block sizes
+	   blocksInBuffer	= 4;
 }
 //
 bool	mp4Processor::processSuperframe (uint8_t frameBytes [],
 	                                 int16_t base) {
 uint8_t		num_aus;
-int16_t		i, j, k;
-uint8_t		rsIn	[120];
-uint8_t		rsOut	[110];
+int16_t		i;
 stream_parms	streamParameters;
 
 /**	apply reed-solomon error repar
   *	OK, what we now have is a vector with RSDims * 120 uint8_t's
   *	Output is a vector with RSDims * 110 uint8_t's
+  *	Codewords with zero syndromes are just copied, only the
+  *	others are passed on to the full decoder
   */
-	for (j = 0; j < RSDims; j ++) {
-	   int16_t ler	= 0;
-	   for (k = 0; k < 120; k ++) 
-	      rsIn [k] = frameBytes [(base + j + k * RSDims) % (RSDims * 120)];
-//
-	   ler = my_rsDecoder. dec (rsIn, rsOut, 135);
-	   if (ler < 0)
-	      return false;
-	   for (k = 0; k < 110; k ++) 
-	      outVector [j + k * RSDims] = rsOut [k];
-	}
+	if (my_rsDecoder. decode (frameBytes, base, outVector. data ()) < 0)
+	   return false;
 //
 //	OK, the result is N * 110 * 8 bits 
 //	bits 0 .. 15 is firecode
@@ -300,7 +316,7 @@ stream_parms	streamParameters;
 	   }
 
 //	but first the crc check
-	   if (check_crc_bytes (&(outVector. data ()) [au_start [i]],
+	   if (check_crc16_bytes (&(outVector. data ()) [au_start [i]],
 	                        aac_frame_length)) {
 	      bool err;
 //
@@ -313,16 +329,28 @@ stream_parms	streamParameters;
                  uint8_t L1   = buffer [count - 2];
                  my_padHandler. processPAD (buffer, count - 3, L1, L0);
               }
-#ifdef	AAC_OUT
-	      std::vector<uint8_t> fileBuffer;
-	      build_aacFile (aac_frame_length,
-	                     &streamParameters,
-	                     &(outVector. data () [au_start [i]]),
-	                     fileBuffer);
-	      if (soundOut != nullptr) 
-	         (soundOut)((int16_t *)(fileBuffer. data ()),
-	                    fileBuffer. size (), 0, false, nullptr);
-#else	
+//
+//	without decoding, the AU is passed on as it is, or in LATM
+//	framing (see build_aacFile). The buffer then contains bytes
+	      if (outputFormat == AUDIO_OUT_AAC) {
+	         if (soundOut != nullptr)
+	            soundOut ((int16_t *)(&outVector [au_start [i]]),
+	                      aac_frame_length, 0,
+	                      streamParameters. aacChannelMode, ctx);
+	         continue;
+	      }
+	      if (outputFormat != AUDIO_OUT_PCM) {
+	         std::vector<uint8_t> fileBuffer;
+	         build_aacFile (aac_frame_length,
+	                        &streamParameters,
+	                        &(outVector. data () [au_start [i]]),
+	                        fileBuffer);
+	         if (soundOut != nullptr) 
+	            soundOut ((int16_t *)(fileBuffer. data ()),
+	                      fileBuffer. size (), 0,
+	                      streamParameters. aacChannelMode, ctx);
+	         continue;
+	      }
 //	we handle the aac -> PMC conversion here
 	
 	      uint8_t theAudioUnit [2 * 960 + 10];	// sure, large enough
@@ -330,9 +358,9 @@ stream_parms	streamParameters;
 	                       &outVector [au_start [i]], aac_frame_length);
 	      memset (&theAudioUnit [aac_frame_length], 0, 10);
 
-	      int tmp = aacDecoder. MP42PCM (&streamParameters,
-	                                     theAudioUnit,
-	                                     aac_frame_length);
+	      int tmp = aacDecoder -> MP42PCM (&streamParameters,
+	                                       theAudioUnit,
+	                                       aac_frame_length);
 	      err = tmp == 0;
 //	      handle_aacFrame (&outVector [au_start [i]],
 //	                       aac_frame_length,
@@ -346,7 +374,6 @@ stream_parms	streamParameters;
 	         aacErrors	= 0;
 	         aacFrames	= 0;
 	      }
-#endif
 	   }
 	   else {
 	      fprintf (stderr, "CRC failure with dab+ frame should not happen\n");
@@ -373,9 +400,12 @@ uint8_t theAudioUnit [2 * 960 + 10];	// sure, large enough
 //           my_padHandler. processPAD (buffer, count - 3, L1, L0);
 //        }
 
-	int tmp = aacDecoder. MP42PCM (sp,
-	                               theAudioUnit,
-	                               frame_length);
+	*error	= true;
+	if (aacDecoder == nullptr)
+	   return;
+	int tmp = aacDecoder -> MP42PCM (sp,
+	                                 theAudioUnit,
+	                                 frame_length);
 	*error	= tmp == 0;
 }
 
@@ -0,0 +1,128 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include	"backend-pool.h"
+#include	"virtual-backend.h"
+//
+//	The pool of the process, created with the first msc handler
+//	and deleted with the last one
+static	std::mutex	poolLocker;
+static	backendPool	*sharedPool	= nullptr;
+static	int32_t		poolUsers	= 0;
+
+backendPool	*backendPool::acquire	(void) {
+	std::lock_guard<std::mutex> lck (poolLocker);
+	if (poolUsers ++ == 0)
+	   sharedPool	= new backendPool ();
+	return sharedPool;
+}
+//
+//	the backends of the handler are removed (and idle) by now
+void	backendPool::release	(void) {
+	std::lock_guard<std::mutex> lck (poolLocker);
+	if (-- poolUsers == 0) {
+	   delete sharedPool;
+	   sharedPool	= nullptr;
+	}
+}
+
+	backendPool::backendPool (int16_t nrThreads) {
+	running. store (false);
+	startWorkers (nrThreads);
+}
+
+	backendPool::~backendPool (void) {
+	stopWorkers ();
+}
+//
+//	Note that the readyList survives a change in the number
+//	of workers, backends scheduled are handled by the new ones
+void	backendPool::setThreads	(int16_t nrThreads) {
+	std::lock_guard<std::mutex> lck (workerLocker);
+	stopWorkers ();
+	startWorkers (nrThreads);
+}
+
+int16_t	backendPool::nrThreads	(void) {
+	std::lock_guard<std::mutex> lck (workerLocker);
+	return workers. size ();
+}
+
+void	backendPool::schedule	(virtualBackend *b) {
+	std::unique_lock<std::mutex> lck (locker);
+	readyList. push_back (b);
+	waiter. notify_one ();
+}
+//
+//	The count is checked with the lock held, and the lock is taken
+//	to notify, so a backend going idle between the check and the
+//	wait is not missed
+void	backendPool::backendIdle	(void) {
+	std::unique_lock<std::mutex> lck (locker);
+	idleWaiter. notify_all ();
+}
+
+void	backendPool::waitIdle	(std::atomic<int32_t> *pendingCount) {
+	std::unique_lock<std::mutex> lck (locker);
+	while (pendingCount -> load () > 0)
+	   idleWaiter. wait (lck);
+}
+//
+//	by default we leave two cores for the ofdm and the
+//	msc handler threads
+void	backendPool::startWorkers (int16_t nrThreads) {
+	if (nrThreads <= 0) {
+	   int16_t cores = std::thread::hardware_concurrency ();
+	   nrThreads	= cores > 2 ? cores - 2 : 1;
+	}
+	running. store (true);
+	for (int i = 0; i < nrThreads; i ++)
+	   workers. push_back (std::thread (&backendPool::run, this));
+}
+
+void	backendPool::stopWorkers (void) {
+	{  std::unique_lock<std::mutex> lck (locker);
+	   running. store (false);
+	   waiter. notify_all ();
+	}
+	for (auto &w : workers)
+	   w. join ();
+	workers. resize (0);
+}
+
+void	backendPool::run	(void) {
+virtualBackend	*b;
+
+	while (true) {
+	   {  std::unique_lock<std::mutex> lck (locker);
+	      while (running. load () && readyList. empty ())
+	         waiter. wait (lck);
+	      if (!running. load ())
+	         return;
+	      b	= readyList. front ();
+	      readyList. pop_front ();
+	   }
+	   b -> processPending ();
+	}
+}
+
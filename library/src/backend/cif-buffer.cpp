@@ -0,0 +1,81 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#include	"cif-buffer.h"
+
+	cifBuffer::cifBuffer	(cifPool *owner, int32_t size):
+	                                            buffer (size, 0) {
+	this	-> owner	= owner;
+	refCount. store (0);
+}
+
+	cifBuffer::~cifBuffer	(void) {
+}
+
+int8_t	*cifBuffer::data	(void) {
+	return buffer. data ();
+}
+
+void	cifBuffer::ref		(void) {
+	refCount. fetch_add (1);
+}
+
+void	cifBuffer::unref	(void) {
+	if (refCount. fetch_sub (1) == 1)
+	   owner -> put (this);
+}
+//
+//	The pool grows on demand: with N backends there are at most
+//	16 (history) + QUEUE_SIZE (the deinterleaver queue) + 1 (being
+//	filled) buffers in use, independent of N
+	cifPool::cifPool	(int32_t cifSize) {
+	this	-> cifSize	= cifSize;
+}
+//
+//	all buffers are supposed to be returned by now
+	cifPool::~cifPool	(void) {
+	for (auto const &b : freeList)
+	   delete b;
+}
+
+cifBuffer	*cifPool::get	(void) {
+cifBuffer	*b;
+
+	locker. lock ();
+	if (freeList. size () == 0)
+	   b	= new cifBuffer (this, cifSize);
+	else {
+	   b	= freeList. back ();
+	   freeList. pop_back ();
+	}
+	locker. unlock ();
+	b	-> refCount. store (1);
+	return b;
+}
+
+void	cifPool::put	(cifBuffer *b) {
+	locker. lock ();
+	freeList. push_back (b);
+	locker. unlock ();
+}
+
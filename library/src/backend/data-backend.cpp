@@ -31,35 +31,19 @@
 //
 //	fragmentsize == Length * CUSize
 	dataBackend::dataBackend	(packetdata	*d,
-	                                 bytesOut_t	bytesOut,
-	                                 motdata_t	motdataHandler,
-	                                 void	*ctx) :
+	                                 backendPool	*thePool) :
                                          virtualBackend (d -> startAddr,
                                                          d -> length),
 	                                 outV (24 * d -> bitRate),
-	                                 freeSlots (20) {
+	                                 deInterleaver (d -> length * CUSize) {
 int32_t i, j;
+	this	-> thePool		= thePool;
         this    -> fragmentSize         = d -> length * CUSize;
         this    -> bitRate              = d -> bitRate;
         this    -> shortForm            = d -> shortForm;
         this    -> protLevel            = d -> protLevel;
-        our_backendBase        = new dataProcessor (bitRate,
-	                                            d,
-                                                    bytesOut,
-	                                            motdataHandler,
-                                                    ctx);
-	nextIn		= 0;
-	nextOut		= 0;
-	for (i = 0; i < 20; i ++)
-	   theData [i] = new int16_t [fragmentSize];
-
+        our_backendBase        = new dataProcessor (bitRate);
 	tempX. resize (fragmentSize);
-	interleaveData		= new int16_t *[16]; // the size
-	for (i = 0; i < 16; i ++) {
-	   interleaveData [i] = new int16_t [fragmentSize];
-	   memset (interleaveData [i], 0, fragmentSize * sizeof (int16_t));
-	}
-	countforInterleaver	= 0;
 //
 //	The handling of the depuncturing and deconvolution is
 //	shared with that of the audio
@@ -87,64 +71,66 @@ int32_t i, j;
 }
 
 	dataBackend::~dataBackend (void) {
-int16_t	i;
-	if (running. load ()) {
-	   threadHandle. join ();
-	   running. store (false);
-	}
+	stopRunning ();
 
 	delete protectionHandler;
-	for (i = 0; i < 16; i ++)
-	   delete[] interleaveData [i];
-	delete[]	interleaveData;
-	for (i = 0; i < 20; i ++)
-	   delete [] theData [i];
 	delete	our_backendBase;
 }
 
 void    dataBackend::start         (void) {
-        threadHandle = std::thread (&dataBackend::run, this);
+	running. store (true);
 }
 
-int32_t	dataBackend::process	(int16_t *v, int16_t cnt) {
-	(void)cnt;
-	while (!freeSlots. tryAcquire (200))
-	   if (!running)
-	      return 0;
-	memcpy (theData [nextIn], v, fragmentSize * sizeof (int16_t));
-	nextIn = (nextIn + 1) % 20;
-	usedSlots. Release ();
-	return 1;
+int16_t	dataBackend::addStream	(packetdata	*d,
+	                         bytesOut_t	bytesOut,
+	                         motdata_t	motdataHandler,
+	                         motSink	*theSink,
+	                         ipSink		*theIPSink,
+	                         void		*ctx) {
+	return our_backendBase -> addStream (d, bytesOut,
+	                                     motdataHandler, theSink,
+	                                     theIPSink, ctx);
 }
 
-const   int16_t interleaveMap[] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
+int16_t	dataBackend::removeStream	(int16_t id) {
+	return our_backendBase -> removeStream (id);
+}
 
-void	dataBackend::run	(void) {
-int16_t	i;
-int16_t	countforInterleaver	= 0;
-int16_t interleaverIndex	= 0;
+void	dataBackend::getStreamStats	(int16_t id,
+	                                 int32_t &frames, int32_t &errors) {
+	our_backendBase -> getStreamStats (id, frames, errors);
+}
 
-	running. store (true);
-	while (running. load ()) {
-	   while (!usedSlots. tryAcquire (200))
-	      if (!running)
-	         return;
+void	dataBackend::primeHistory	(std::vector<cifBuffer *> &h) {
+	deInterleaver. prime (h, startAddress * CUSize);
+}
 
-	   for (i = 0; i < fragmentSize; i ++) {
-	      tempX [i] = interleaveData [(interleaverIndex +
-	                          interleaveMap [i & 017]) & 017][i];
-	      interleaveData [interleaverIndex][i] = theData [nextOut] [i];
-	   }
-	   nextOut = (nextOut + 1) % 20;
-	   freeSlots. Release ();
+bool	dataBackend::sameSubchannel	(int16_t startAddr, int16_t length,
+	                                 bool shortForm, int16_t protLevel,
+	                                 int16_t bitRate) {
+	return (startAddr	== this -> startAddress) &&
+	       (length		== this -> segmentLength) &&
+	       (shortForm	== this -> shortForm) &&
+	       (protLevel	== this -> protLevel) &&
+	       (bitRate		== this -> bitRate);
+}
 
-	   interleaverIndex = (interleaverIndex + 1) & 0x0F;
+int32_t	dataBackend::process	(cifBuffer *cif,
+	                         int32_t offset, int16_t cnt) {
+	(void)cnt;
+	if (!deInterleaver. add (cif, offset, running))
+	   return 0;
+	fragmentAdded (thePool);
+	return 1;
+}
+//
+//	executed by a worker of the pool
+void	dataBackend::processPending	(void) {
+int16_t	i;
 
-//	only continue when de-interleaver is filled
-	   if (countforInterleaver <= 15) {
-	      countforInterleaver ++;
+	do {
+	   if (!deInterleaver. fetch (tempX. data ()) || !running. load ())
 	      continue;
-	   }
 //
 	   protectionHandler -> deconvolve (tempX. data (),
 	                                       fragmentSize, outV. data ());
@@ -156,12 +142,12 @@ int16_t interleaverIndex	= 0;
 //	but forming a DAB packet
 //	we hand it over to make an MSC data group
 	   our_backendBase -> addtoFrame (outV. data ());
-	}
+	} while (fragmentDone (thePool));
 }
 
 //	It might take a msec for the task to stop
 void	dataBackend::stopRunning (void) {
 	running. store (false);
-	threadHandle. join ();
+	waitforIdle (thePool);
 }
 
@@ -25,56 +25,137 @@
 #include	"virtual-datahandler.h"
 #include	"mot-handler.h"
 #include        "tdc-datahandler.h"
+#include	"ip-datahandler.h"
+#include	"crc-handler.h"
 
 //	\class dataProcessor
 //	The main function of this class is to assemble the 
 //	MSCdatagroups and dispatch to the appropriate handler
 //
 //	fragmentsize == Length * CUSize
-	dataProcessor::dataProcessor	(int16_t	bitRate,
-	                                 packetdata	*pd,
+	dataProcessor::dataProcessor	(int16_t	bitRate) {
+	this	-> bitRate		= bitRate;
+	crcErrors			= 0;
+	handledPackets			= 0;
+	nextId				= 0;
+	asyncStream			= false;
+}
+
+	dataProcessor::~dataProcessor	(void) {
+	for (auto const &st : streams) {
+	   delete st -> my_dataHandler;
+	   delete st;
+	}
+}
+
+int16_t	dataProcessor::addStream	(packetdata	*pd,
 	                                 bytesOut_t	bytesOut,
 	                                 motdata_t	motdataHandler,
-	                                 void	        *ctx) {
-
-	this	-> bitRate		= pd -> bitRate;
-	this	-> DSCTy		= pd -> DSCTy;
-	this	-> appType		= pd -> appType;
-	this	-> packetAddress	= pd -> packetAddress;
-	this	-> DGflag		= pd -> DGflag;
-	this	-> FEC_scheme		= pd -> FEC_scheme;
-	this	-> bytesOut		= bytesOut;
-	this	-> ctx			= ctx;
-	switch (DSCTy) {
+	                                 motSink	*theSink,
+	                                 ipSink		*theIPSink,
+	                                 void		*ctx) {
+packetStream	*st;
+int16_t		id;
+
+	streamLocker. lock ();
+	for (auto const &s : streams)
+	   if ((s -> packetAddress == pd -> packetAddress) &&
+	       (s -> DSCTy == pd -> DSCTy) &&
+	       (s -> bytesOut == bytesOut) &&
+	       (s -> motdataHandler == motdataHandler) &&
+	       (s -> ctx == ctx)) {
+	      s -> refCount ++;
+	      id	= s -> id;
+	      streamLocker. unlock ();
+	      return id;
+	   }
+
+	st			= new packetStream;
+	st	-> id		= nextId ++;
+	st	-> refCount	= 1;
+	st	-> packetAddress	= pd -> packetAddress;
+	st	-> DSCTy	= pd -> DSCTy;
+	st	-> appType	= pd -> appType;
+	st	-> DGflag	= pd -> DGflag;
+	st	-> bytesOut	= bytesOut;
+	st	-> motdataHandler	= motdataHandler;
+	st	-> ctx		= ctx;
+	st	-> packetState	= 0;
+	st	-> series	= groupPool. get ();
+	switch (st -> DSCTy) {
 	   default:
-	      my_dataHandler	= new virtual_dataHandler ();
+	      st -> my_dataHandler	= new virtual_dataHandler ();
 	      break;
 
 	   case 5:			// do know yet
-	      my_dataHandler	= new tdc_dataHandler (appType, bytesOut, ctx);
+	      st -> my_dataHandler	= new tdc_dataHandler (st -> appType,
+	                                                       bytesOut, ctx);
+	      break;
+
+	   case 59:
+	      st -> my_dataHandler	= new ip_dataHandler (theIPSink);
 	      break;
 
 	   case 60:
-	      my_dataHandler	= new motHandler (motdataHandler, ctx);
+	      st -> my_dataHandler	= new motHandler (motdataHandler,
+	                                                  theSink, ctx);
 	      break;
 	}
-
-	packetState	= 0;
+//	There is - obviously - some exception, that is
+//	when the DG flag is on and there are no datagroups for DSCTy5
+	if ((st -> DSCTy == 5) && st -> DGflag)
+	   asyncStream	= true;
+	streams. push_back (st);
+	id	= st -> id;
+	streamLocker. unlock ();
+	return id;
 }
 
-	dataProcessor::~dataProcessor	(void) {
-	delete		my_dataHandler;
+int16_t	dataProcessor::removeStream	(int16_t id) {
+int16_t	left;
+
+	streamLocker. lock ();
+	for (uint16_t i = 0; i < streams. size (); i ++) {
+	   packetStream *st	= streams [i];
+	   if (st -> id != id)
+	      continue;
+	   if (-- st -> refCount == 0) {
+	      delete st -> my_dataHandler;
+	      delete st;
+	      streams. erase (streams. begin () + i);
+	   }
+	   break;
+	}
+	asyncStream	= false;
+	for (auto const &st : streams)
+	   if ((st -> DSCTy == 5) && st -> DGflag)
+	      asyncStream = true;
+	left	= streams. size ();
+	streamLocker. unlock ();
+	return left;
 }
 
+void	dataProcessor::getStreamStats	(int16_t id,
+	                                 int32_t &frames, int32_t &errors) {
+	frames	= 0;
+	errors	= 0;
+	streamLocker. lock ();
+	for (auto const &st : streams)
+	   if (st -> id == id) {
+	      st -> my_dataHandler -> getStats (frames, errors);
+	      break;
+	   }
+	streamLocker. unlock ();
+}
 
 void	dataProcessor::addtoFrame (uint8_t *outV) {
-//	There is - obviously - some exception, that is
-//	when the DG flag is on and there are no datagroups for DSCTy5
-	   if ((this -> DSCTy == 5) &&
-	       (this -> DGflag))	// no datagroups
-	      handleTDCAsyncstream (outV, 24 * bitRate);
-	   else
-	      handlePackets (outV, 24 * bitRate);
+	streamLocker. lock ();
+	if (asyncStream)
+	   handleTDCAsyncstream (outV, 24 * bitRate);
+	handlePackets (outV, 24 * bitRate);
+	for (auto const &st : streams)
+	   st -> my_dataHandler -> flush ();
+	streamLocker. unlock ();
 }
 //
 //	While for a full mix data and audio there will be a single packet in a
@@ -93,10 +174,8 @@ void	dataProcessor::handlePackets (uint8_t *data, int16_t length) {
 }
 //
 //	Handle a single DAB packet:
-//	Note, although not yet encountered, the standard says that
-//	there may be multiple streams, to be identified by
-//	the address. For the time being we only handle a single
-//	stream!!!!
+//	the crc is checked once, the packet is then handed to
+//	each of the streams with the address of the packet
 void	dataProcessor::handlePacket (uint8_t *data) {
 int16_t	packetLength	= (getBits_2 (data, 0) + 1) * 24;
 int16_t	continuityIndex	= getBits_2 (data, 2);
@@ -104,68 +183,81 @@ int16_t	firstLast	= getBits_2 (data, 4);
 int16_t	address		= getBits   (data, 6, 10);
 uint16_t command	= getBits_1 (data, 16);
 int16_t	usefulLength	= getBits_7 (data, 17);
-uint16_t	i;
 //	if (usefulLength > 0)
 //	fprintf (stderr, "CI = %d, address = %d, usefulLength = %d\n",
 //	                 continuityIndex, address, usefulLength);
 
 	(void)continuityIndex;
 	(void)command;
-	if (!check_CRC_bits (data, packetLength * 8)) {
-	   crcErrors ++;
-	   return;
-	}
 	if (address == 0)
 	   return;		// padding packet
 //
-	if (address != packetAddress)	// sorry, other stream
+//	no crc check for packets that nobody wants
+	bool wanted	= false;
+	for (auto const &st : streams)
+	   if ((st -> packetAddress == address) &&
+	       !((st -> DSCTy == 5) && st -> DGflag))
+	      wanted = true;
+	if (!wanted)
 	   return;
-	
-//	assemble the full MSC datagroup
-	if (packetState == 0) {	// waiting for a start
+
+	if (!check_crc16_bits (data, packetLength * 8)) {
+	   crcErrors ++;
+	   return;
+	}
+	handledPackets ++;
+	for (auto const &st : streams)
+	   if ((st -> packetAddress == address) &&
+	       !((st -> DSCTy == 5) && st -> DGflag))
+	      addtoStream (st, data, firstLast, usefulLength);
+}
+//
+//	assemble the full MSC datagroup in a pooled buffer, a complete
+//	datagroup is moved to the datahandler, the stream continues
+//	with a fresh buffer from the pool
+void	dataProcessor::addtoStream	(packetStream *st, uint8_t *data,
+	                                 int16_t firstLast,
+	                                 int16_t usefulLength) {
+dataGroup	&series	= st -> series;
+
+	if (!series. isValid ())
+	   series	= groupPool. get ();
+
+	if (st -> packetState == 0) {	// waiting for a start
 	   if (firstLast == 02) {	// first packet
-	      packetState = 1;
-	      series. resize (usefulLength * 8);
-	      for (i = 0; i < series. size (); i ++)
-	         series [i] = data [24 + i];
+	      st -> packetState = 1;
+	      series. clear ();
+	      series. append (&data [24], 8 * usefulLength);
 	   }
 	   else
 	   if (firstLast == 03) {	// single packet, mostly padding
-	      series. resize (usefulLength * 8);
-	      for (i = 0; i < series. size (); i ++)
-	         series [i] = data [24 + i];
-	      my_dataHandler	-> add_mscDatagroup (series);
+	      series. clear ();
+	      series. append (&data [24], 8 * usefulLength);
+	      st -> my_dataHandler	-> add_mscDatagroup (std::move (series));
 	   }
 	   else 
-	      series. resize (0);	// packetState remains 0
+	      series. clear ();	// packetState remains 0
 	}
 	else
-	if (packetState == 01) {	// within a series
+	if (st -> packetState == 01) {	// within a series
 	   if (firstLast == 0) {	// intermediate packet
-	      int32_t currentLength = series. size ();
-	      series. resize (currentLength + 8 * usefulLength);
-	      for (i = 0; i < 8 * usefulLength; i ++)
-	         series [currentLength + i] = data [24 + i];
+	      series. append (&data [24], 8 * usefulLength);
 	   }
 	   else
 	   if (firstLast == 01) {	// last packet
-	      int32_t currentLength = series. size ();
-	      series. resize (currentLength + 8 * usefulLength);
-	      for (i = 0; i < 8 * usefulLength; i ++)
-	         series [currentLength + i] = data [24 + i];
-	      my_dataHandler	-> add_mscDatagroup (series);
-	      packetState = 0;
+	      series. append (&data [24], 8 * usefulLength);
+	      st -> my_dataHandler	-> add_mscDatagroup (std::move (series));
+	      st -> packetState = 0;
 	   }
 	   else
 	   if (firstLast == 02) {	// first packet, previous one erroneous
-	      packetState = 1;
-	      series. resize (usefulLength * 8);
-	      for (i = 0; i < series. size (); i ++)
-	         series [i] = data [24 + i];
+	      st -> packetState = 1;
+	      series. clear ();
+	      series. append (&data [24], 8 * usefulLength);
 	   }
 	   else {
-	      packetState = 0;
-	      series. resize (0);
+	      st -> packetState = 0;
+	      series. clear ();
 	   }
 	}
 }
@@ -187,7 +279,7 @@ int16_t	usefulLength	= getBits_7 (data, 17);
 	(void)	address;
 	(void)	command;
 	(void)	usefulLength;
-	if (!check_CRC_bits (data, packetLength * 8))
+	if (!check_crc16_bits (data, packetLength * 8))
 	   return;
 }
 
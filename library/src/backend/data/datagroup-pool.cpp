@@ -0,0 +1,150 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#
+#include	"datagroup-pool.h"
+#include	<string.h>
+
+	dataGroup::dataGroup	(void) {
+	owner	= nullptr;
+	buffer	= nullptr;
+}
+
+	dataGroup::dataGroup	(dataGroupPool *owner,
+	                         std::vector<uint8_t> *buffer) {
+	this	-> owner	= owner;
+	this	-> buffer	= buffer;
+}
+
+	dataGroup::dataGroup	(dataGroup &&other) {
+	owner		= other. owner;
+	buffer		= other. buffer;
+	other. owner	= nullptr;
+	other. buffer	= nullptr;
+}
+
+	dataGroup::~dataGroup	(void) {
+	release ();
+}
+
+dataGroup	&dataGroup::operator =	(dataGroup &&other) {
+	if (this != &other) {
+	   release ();
+	   owner	= other. owner;
+	   buffer	= other. buffer;
+	   other. owner		= nullptr;
+	   other. buffer	= nullptr;
+	}
+	return *this;
+}
+
+bool	dataGroup::isValid	(void) const {
+	return buffer != nullptr;
+}
+
+uint8_t	*dataGroup::data	(void) {
+	return buffer == nullptr ? nullptr : buffer -> data ();
+}
+
+int32_t	dataGroup::size		(void) const {
+	return buffer == nullptr ? 0 : buffer -> size ();
+}
+
+void	dataGroup::clear	(void) {
+	if (buffer != nullptr)
+	   buffer -> clear ();
+}
+//
+//	resize keeps the capacity, it only allocates when a datagroup
+//	is larger than any of the ones assembled in this buffer before
+void	dataGroup::append	(const uint8_t *v, int32_t amount) {
+int32_t	currentLength;
+
+	if ((buffer == nullptr) || (amount <= 0))
+	   return;
+	currentLength	= buffer -> size ();
+	buffer	-> resize (currentLength + amount);
+	memcpy (buffer -> data () + currentLength, v, amount);
+}
+
+//
+//	byte i is built from bytes 8 * i .. 8 * i + 7, so it can
+//	be written in the same buffer. Remaining bits are dropped
+int32_t	dataGroup::pack		(void) {
+uint8_t	*d;
+int32_t	bytes;
+
+	if (buffer == nullptr)
+	   return 0;
+	d	= buffer -> data ();
+	bytes	= buffer -> size () / 8;
+	for (int32_t i = 0; i < bytes; i ++) {
+	   const uint8_t *b	= &d [8 * i];
+	   d [i] = ((b [0] & 1) << 7) | ((b [1] & 1) << 6) |
+	           ((b [2] & 1) << 5) | ((b [3] & 1) << 4) |
+	           ((b [4] & 1) << 3) | ((b [5] & 1) << 2) |
+	           ((b [6] & 1) << 1) |  (b [7] & 1);
+	}
+	buffer	-> resize (bytes);
+	return bytes;
+}
+
+void	dataGroup::release	(void) {
+	if (buffer != nullptr)
+	   owner -> put (buffer);
+	owner	= nullptr;
+	buffer	= nullptr;
+}
+
+	dataGroupPool::dataGroupPool	(int32_t initialSize) {
+	this	-> initialSize	= initialSize;
+}
+
+	dataGroupPool::~dataGroupPool	(void) {
+	for (auto const &b : freeList)
+	   delete b;
+}
+
+dataGroup	dataGroupPool::get	(void) {
+std::vector<uint8_t>	*b;
+
+	locker. lock ();
+	if (freeList. size () == 0) {
+	   b	= new std::vector<uint8_t>;
+	   b	-> reserve (initialSize);
+	}
+	else {
+	   b	= freeList. back ();
+	   freeList. pop_back ();
+	}
+	locker. unlock ();
+	b	-> clear ();
+	return dataGroup (this, b);
+}
+
+void	dataGroupPool::put	(std::vector<uint8_t> *b) {
+	locker. lock ();
+	freeList. push_back (b);
+	locker. unlock ();
+}
+
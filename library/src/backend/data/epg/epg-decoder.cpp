@@ -0,0 +1,639 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#include	"epg-decoder.h"
+#include	<stdio.h>
+#include	<string.h>
+#include	<time.h>
+#include	<algorithm>
+#include	<unordered_map>
+//
+//	the tags (ETSI TS 102 371, 4.5 and 4.6) we are interested in
+#define	CDATA_TAG		0x01
+#define	EPG_TAG			0x02
+#define	TOKEN_TABLE_TAG		0x04
+#define	DEFAULT_ID_TAG		0x05
+#define	SHORTNAME_TAG		0x10
+#define	MEDIUMNAME_TAG		0x11
+#define	LONGNAME_TAG		0x12
+#define	MEDIADESCRIPTION_TAG	0x13
+#define	LOCATION_TAG		0x19
+#define	SHORTDESCRIPTION_TAG	0x1A
+#define	LONGDESCRIPTION_TAG	0x1B
+#define	PROGRAMME_TAG		0x1C
+#define	SCHEDULE_TAG		0x21
+#define	SCOPE_TAG		0x24
+#define	SERVICESCOPE_TAG	0x25
+#define	TIME_TAG		0x2C
+#define	BEARER_TAG		0x2D
+//
+//	attributes are numbered per element, starting at 0x80
+#define	ATTRIBUTE_0		0x80
+#define	ATTRIBUTE_1		0x81
+//
+//	a programme is broadcast at at most this number of locations
+#define	MAX_LOCATIONS		4
+#define	NO_TIME			(-1)
+
+static inline
+uint16_t get_uint16 (const uint8_t *p) {
+	return (p [0] << 8) | p [1];
+}
+
+static inline
+uint32_t get_uint24 (const uint8_t *p) {
+	return (p [0] << 16) | (p [1] << 8) | p [2];
+}
+
+	epgDecoder::epgDecoder	(int32_t maxProgrammes) {
+	this	-> maxProgrammes	= maxProgrammes;
+	this	-> sequence		= 0;
+	this	-> defaultSId		= 0;
+	this	-> found		= 0;
+	pool. push_back (0);		// offset 0 is the empty string
+	poolLimit			= 65536;
+}
+
+	epgDecoder::~epgDecoder	(void) {
+}
+
+void	epgDecoder::clear	(void) {
+	std::lock_guard<std::mutex> lck (locker);
+	programmes. clear ();
+	origins. clear ();
+	pool. resize (1);
+}
+//
+//	The object is decoded as it is, the programmes are added to
+//	the store straight away. A previous version of the object -
+//	recognized by its name - is removed first.
+int32_t	epgDecoder::decode	(const uint8_t *data, int32_t length,
+	                         const std::string &name) {
+const uint8_t	*p	= data;
+const uint8_t	*end	= data + length;
+tlv	object;
+
+	if ((data == nullptr) || !nextTLV (p, end, object) ||
+	                         (object. tag != EPG_TAG))
+	   return -1;		// e.g. service information
+
+	std::lock_guard<std::mutex> lck (locker);
+	for (auto it = origins. begin (); it != origins. end (); it ++) {
+	   if (it -> name == name) {
+	      removeOrigin (it -> sequence);
+	      origins. erase (it);
+	      break;
+	   }
+	}
+
+	sequence ++;
+	origins. push_back ({name, sequence});
+	for (int i = 0; i < 20; i ++)
+	   tokens [i]. clear ();
+	defaultSId	= 0;
+	found		= 0;
+	handle_epg (object);
+	if (found == 0)
+	   origins. pop_back ();
+//
+//	order on SId and starting time, when the same programme
+//	occurs in more than one object, the newest one is kept
+	std::sort (programmes. begin (), programmes. end (),
+	           [] (const programme &a, const programme &b) {
+	              if (a. SId != b. SId)
+	                 return a. SId < b. SId;
+	              if (a. startTime != b. startTime)
+	                 return a. startTime < b. startTime;
+	              return a. origin > b. origin;
+	           });
+	programmes. erase (std::unique (programmes. begin (),
+	                                programmes. end (),
+	                   [] (const programme &a, const programme &b) {
+	                      return (a. SId == b. SId) &&
+	                             (a. startTime == b. startTime);
+	                   }), programmes. end ());
+
+	while ((programmes. size () > (size_t)maxProgrammes) &&
+	                                   (origins. size () > 1)) {
+	   removeOrigin (origins. front (). sequence);
+	   origins. pop_front ();
+	}
+	if (pool. size () > poolLimit)
+	   compact ();
+	return found;
+}
+
+bool	epgDecoder::nextTLV	(const uint8_t *&p,
+	                         const uint8_t *end, tlv &t) {
+int32_t	length;
+
+	if (end - p < 2)
+	   return false;
+	t. tag	= *p ++;
+	length	= *p ++;
+	if (length == 0xFE) {
+	   if (end - p < 2)
+	      return false;
+	   length	= get_uint16 (p);
+	   p += 2;
+	}
+	else
+	if (length == 0xFF) {
+	   if (end - p < 3)
+	      return false;
+	   length	= get_uint24 (p);
+	   p += 3;
+	}
+	if (end - p < length)
+	   return false;
+	t. value	= p;
+	t. length	= length;
+	p	+= length;
+	return true;
+}
+
+void	epgDecoder::handle_epg	(const tlv &object) {
+const uint8_t	*p	= object. value;
+const uint8_t	*end	= object. value + object. length;
+tlv	a;
+
+	while (nextTLV (p, end, a)) {
+	   switch (a. tag) {
+	      case TOKEN_TABLE_TAG:
+	         set_tokenTable (a);
+	         break;
+
+	      case DEFAULT_ID_TAG:
+	         defaultSId	= contentId (a. value, a. length);
+	         break;
+
+	      case SCHEDULE_TAG:
+	         handle_schedule (a);
+	         break;
+
+	      default:		// attributes, programme groups
+	         break;
+	   }
+	}
+}
+
+void	epgDecoder::handle_schedule	(const tlv &schedule) {
+const uint8_t	*p	= schedule. value;
+const uint8_t	*end	= schedule. value + schedule. length;
+uint32_t	scopeSId	= defaultSId;
+tlv	a;
+
+	while (nextTLV (p, end, a)) {
+	   if (a. tag == SCOPE_TAG)
+	      handle_scope (a, scopeSId);
+	   else
+	   if (a. tag == PROGRAMME_TAG)
+	      handle_programme (a, scopeSId);
+	}
+}
+//
+//	the service the schedule is for, if given,  is the first
+//	serviceScope in the scope
+void	epgDecoder::handle_scope	(const tlv &scope, uint32_t &SId) {
+const uint8_t	*p	= scope. value;
+const uint8_t	*end	= scope. value + scope. length;
+tlv	a, b;
+
+	while (nextTLV (p, end, a)) {
+	   if (a. tag != SERVICESCOPE_TAG)
+	      continue;
+	   const uint8_t *q	= a. value;
+	   while (nextTLV (q, a. value + a. length, b)) {
+	      if (b. tag == ATTRIBUTE_0) {
+	         uint32_t id	= contentId (b. value, b. length);
+	         if (id != 0) {
+	            SId	= id;
+	            return;
+	         }
+	      }
+	   }
+	}
+}
+//
+//	The locations come before the media descriptions, so the
+//	entries - one per location - are only added at the end
+void	epgDecoder::handle_programme	(const tlv &prog, uint32_t SId) {
+const uint8_t	*p	= prog. value;
+const uint8_t	*end	= prog. value + prog. length;
+programme	base;
+programme	locations [MAX_LOCATIONS];
+int		nrLocations	= 0;
+size_t		poolMark	= pool. size ();
+tlv	a, b;
+
+	base. SId		= SId;
+	base. shortId		= 0;
+	base. startTime		= NO_TIME;
+	base. duration		= 0;
+	base. origin		= sequence;
+	base. id		= 0;
+	base. shortName		= 0;
+	base. mediumName	= 0;
+	base. longName		= 0;
+	base. shortDescription	= 0;
+	base. longDescription	= 0;
+
+	while (nextTLV (p, end, a)) {
+	   switch (a. tag) {
+	      case ATTRIBUTE_0:		// id, a crid
+	         if (base. id == 0)
+	            base. id	= addString (a. value, a. length);
+	         break;
+
+	      case ATTRIBUTE_1:		// shortId
+	         if (a. length >= 3)
+	            base. shortId	= get_uint24 (a. value);
+	         break;
+
+	      case SHORTNAME_TAG:
+	         if (base. shortName == 0)
+	            base. shortName	= handle_text (a);
+	         break;
+
+	      case MEDIUMNAME_TAG:
+	         if (base. mediumName == 0)
+	            base. mediumName	= handle_text (a);
+	         break;
+
+	      case LONGNAME_TAG:
+	         if (base. longName == 0)
+	            base. longName	= handle_text (a);
+	         break;
+
+	      case MEDIADESCRIPTION_TAG: {
+	         const uint8_t *q = a. value;
+	         while (nextTLV (q, a. value + a. length, b)) {
+	            if ((b. tag == SHORTDESCRIPTION_TAG) &&
+	                                  (base. shortDescription == 0))
+	               base. shortDescription	= handle_text (b);
+	            else
+	            if ((b. tag == LONGDESCRIPTION_TAG) &&
+	                                  (base. longDescription == 0))
+	               base. longDescription	= handle_text (b);
+	         }
+	         break;
+	      }
+
+	      case LOCATION_TAG:
+	         if (nrLocations < MAX_LOCATIONS) {
+	            locations [nrLocations]	= base;
+	            handle_location (a, locations [nrLocations]);
+	            if (locations [nrLocations]. startTime != NO_TIME)
+	               nrLocations ++;
+	         }
+	         break;
+
+	      default:		// genre, links, memberOf etc
+	         break;
+	   }
+	}
+//
+//	without a time there is nothing to show
+	if (nrLocations == 0) {
+	   pool. resize (poolMark);
+	   return;
+	}
+
+	for (int i = 0; i < nrLocations; i ++) {
+	   programme	prog	= base;
+	   prog. SId		= locations [i]. SId;
+	   prog. startTime	= locations [i]. startTime;
+	   prog. duration	= locations [i]. duration;
+	   programmes. push_back (prog);
+	   found ++;
+	}
+}
+//
+//	the first time and the first bearer of the location count
+void	epgDecoder::handle_location	(const tlv &location,
+	                                 programme &prog) {
+const uint8_t	*p	= location. value;
+const uint8_t	*end	= location. value + location. length;
+bool	bearerSeen	= false;
+tlv	a, b;
+
+	while (nextTLV (p, end, a)) {
+	   if ((a. tag == TIME_TAG) && (prog. startTime == NO_TIME)) {
+	      const uint8_t *q	= a. value;
+	      while (nextTLV (q, a. value + a. length, b)) {
+	         if (b. tag == ATTRIBUTE_0)
+	            prog. startTime	= timePoint (b. value, b. length);
+	         else
+	         if ((b. tag == ATTRIBUTE_1) && (b. length >= 2))
+	            prog. duration	= get_uint16 (b. value);
+	      }
+	   }
+	   else
+	   if ((a. tag == BEARER_TAG) && !bearerSeen) {
+	      const uint8_t *q	= a. value;
+	      while (nextTLV (q, a. value + a. length, b)) {
+	         if (b. tag == ATTRIBUTE_0) {
+	            uint32_t id	= contentId (b. value, b. length);
+	            if (id != 0) {
+	               prog. SId	= id;
+	               bearerSeen	= true;
+	            }
+	         }
+	      }
+	   }
+	}
+}
+//
+//	names and descriptions carry their text as cdata, possibly
+//	preceded by a language attribute
+uint32_t	epgDecoder::handle_text	(const tlv &text) {
+const uint8_t	*p	= text. value;
+const uint8_t	*end	= text. value + text. length;
+tlv	a;
+
+	while (nextTLV (p, end, a))
+	   if (a. tag == CDATA_TAG)
+	      return addString (a. value, a. length);
+	return 0;
+}
+//
+//	The token table of the object, each token is
+//	a byte in the range 1 .. 19, followed by a length and the text
+void	epgDecoder::set_tokenTable	(const tlv &table) {
+int32_t	i	= 0;
+
+	for (int j = 0; j < 20; j ++)
+	   tokens [j]. clear ();
+	while (i + 2 <= table. length) {
+	   uint8_t	token	= table. value [i];
+	   int32_t	length	= table. value [i + 1];
+	   i += 2;
+	   if (i + length > table. length)
+	      break;
+	   if (token < 20)
+	      tokens [token]. assign ((const char *)&table. value [i], length);
+	   i += length;
+	}
+}
+//
+//	strings are expanded - the tokens replaced by their text -
+//	directly into the pool
+uint32_t	epgDecoder::addString	(const uint8_t *p, int32_t length) {
+uint32_t	offset	= pool. size ();
+
+	for (int32_t i = 0; i < length; i ++) {
+	   uint8_t c	= p [i];
+	   if ((1 <= c) && (c <= 19) &&
+	                   (c != 0x09) && (c != 0x0A) && (c != 0x0D))
+	      pool. insert (pool. end (),
+	                    tokens [c]. begin (), tokens [c]. end ());
+	   else
+	   if (c != 0)
+	      pool. push_back (c);
+	}
+	if (pool. size () == offset)
+	   return 0;
+	pool. push_back (0);
+	return offset;
+}
+//
+//	contentId: flags (ensemble, xpad, long SId), optionally
+//	ECC and EId, and a 16 or 32 bit SId
+uint32_t	epgDecoder::contentId	(const uint8_t *p, int32_t length) {
+int32_t	n	= 1;
+
+	if (length < 3)
+	   return 0;
+	if (p [0] & 0x80)
+	   n += 3;
+	if (p [0] & 0x20) {
+	   if (length < n + 4)
+	      return 0;
+	   return (get_uint16 (&p [n]) << 16) | get_uint16 (&p [n + 2]);
+	}
+	if (length < n + 2)
+	   return 0;
+	return get_uint16 (&p [n]);
+}
+//
+//	timePoint: MJD, flags and the UTC time, with the seconds
+//	only in the long form. The local time offset is not needed,
+//	times are kept in UTC
+int64_t	epgDecoder::timePoint	(const uint8_t *p, int32_t length) {
+uint32_t	mjd;
+int32_t	hours, minutes, seconds	= 0;
+
+	if (length < 4)
+	   return NO_TIME;
+	mjd	= (get_uint24 (p) >> 6) & 0x1FFFF;
+	hours	= ((p [2] & 0x07) << 2) | (p [3] >> 6);
+	minutes	= p [3] & 0x3F;
+	if ((p [2] & 0x08) && (length >= 6))
+	   seconds	= p [4] >> 2;
+	return ((int64_t)mjd - 40587) * 86400 +
+	                      hours * 3600 + minutes * 60 + seconds;
+}
+
+void	epgDecoder::removeOrigin	(uint32_t origin) {
+	programmes. erase (std::remove_if (programmes. begin (),
+	                                   programmes. end (),
+	                   [origin] (const programme &p) {
+	                      return p. origin == origin;
+	                   }), programmes. end ());
+}
+//
+//	strings of removed programmes stay in the pool until it
+//	is rebuilt, which happens when its size doubled
+void	epgDecoder::compact	(void) {
+std::vector<char>	newPool;
+std::unordered_map<uint32_t, uint32_t> moved;
+
+	newPool. push_back (0);
+	moved [0]	= 0;
+	for (auto &prog: programmes) {
+	   uint32_t *refs [] = {&prog. id, &prog. shortName,
+	                        &prog. mediumName, &prog. longName,
+	                        &prog. shortDescription,
+	                        &prog. longDescription};
+	   for (uint32_t *ref: refs) {
+	      auto it	= moved. find (*ref);
+	      if (it != moved. end ()) {
+	         *ref	= it -> second;
+	         continue;
+	      }
+	      uint32_t offset	= newPool. size ();
+	      const char *s	= &pool [*ref];
+	      newPool. insert (newPool. end (), s, s + strlen (s) + 1);
+	      moved [*ref]	= offset;
+	      *ref		= offset;
+	   }
+	}
+	pool. swap (newPool);
+	poolLimit	= std::max ((size_t)65536, 2 * pool. size ());
+}
+
+const char	*epgDecoder::getString	(uint32_t offset) {
+	return &pool [offset];
+}
+//
+//	The programmes are ordered on SId and starting time
+int32_t	epgDecoder::getProgrammes	(uint32_t SId,
+	                                 int64_t from, int64_t to,
+	                                 epgProgramme_t handler,
+	                                 void *ctx) {
+int32_t	amount	= 0;
+epgProgramme	p;
+
+	std::lock_guard<std::mutex> lck (locker);
+	auto it	= std::lower_bound (programmes. begin (), programmes. end (),
+	                            SId,
+	                   [] (const programme &a, uint32_t SId) {
+	                      return a. SId < SId;
+	                   });
+	for (; it != programmes. end (); it ++) {
+	   if ((SId != 0) && (it -> SId != SId))
+	      break;
+	   int64_t stopTime	= it -> startTime +
+	                          (it -> duration > 0 ? it -> duration : 1);
+	   if ((it -> startTime >= to) || (stopTime <= from))
+	      continue;
+	   p. SId		= it -> SId;
+	   p. shortId		= it -> shortId;
+	   p. startTime		= it -> startTime;
+	   p. duration		= it -> duration;
+	   p. id		= getString (it -> id);
+	   p. name		= getString (it -> longName != 0 ? it -> longName :
+	                                  it -> mediumName != 0 ?
+	                                           it -> mediumName :
+	                                           it -> shortName);
+	   p. description	= getString (it -> longDescription != 0 ?
+	                                      it -> longDescription :
+	                                      it -> shortDescription);
+	   if (handler != nullptr)
+	      handler (&p, ctx);
+	   amount ++;
+	}
+	return amount;
+}
+
+static
+void	writeText	(FILE *f, const char *s) {
+	for (; *s != 0; s ++) {
+	   switch (*s) {
+	      case '&':	fputs ("&amp;", f); break;
+	      case '<':	fputs ("&lt;", f); break;
+	      case '>':	fputs ("&gt;", f); break;
+	      case '"':	fputs ("&quot;", f); break;
+	      default:	fputc (*s, f); break;
+	   }
+	}
+}
+
+static
+void	writeElement	(FILE *f, const char *indent,
+	                 const char *name, const char *s) {
+	if (*s == 0)
+	   return;
+	fprintf (f, "%s<%s>", indent, name);
+	writeText (f, s);
+	fprintf (f, "</%s>\n", name);
+}
+
+static
+void	writeTime	(FILE *f, int64_t t) {
+time_t	tt	= (time_t)t;
+struct tm	tm;
+char	buffer [32];
+
+	gmtime_r (&tt, &tm);
+	strftime (buffer, sizeof (buffer), "%Y-%m-%dT%H:%M:%SZ", &tm);
+	fputs (buffer, f);
+}
+
+static
+void	writeDuration	(FILE *f, int32_t seconds) {
+	fputs ("PT", f);
+	if (seconds >= 3600)
+	   fprintf (f, "%dH", seconds / 3600);
+	if ((seconds % 3600) >= 60)
+	   fprintf (f, "%dM", (seconds % 3600) / 60);
+	if (((seconds % 60) != 0) || (seconds == 0))
+	   fprintf (f, "%dS", seconds % 60);
+}
+//
+//	The XML has the structure of an SPI programme information
+//	document, with a schedule per service
+bool	epgDecoder::exportXml	(const std::string &fileName) {
+FILE	*f	= fopen (fileName. c_str (), "w");
+bool	inSchedule	= false;
+uint32_t	currentSId	= 0;
+
+	if (f == nullptr)
+	   return false;
+
+	std::lock_guard<std::mutex> lck (locker);
+	fprintf (f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	fprintf (f, "<epg system=\"DAB\">\n");
+	for (auto &prog: programmes) {
+	   if (!inSchedule || (prog. SId != currentSId)) {
+	      if (inSchedule)
+	         fprintf (f, " </schedule>\n");
+	      fprintf (f, " <schedule>\n");
+	      fprintf (f, "  <scope><serviceScope id=\"%X\"/></scope>\n",
+	                                                   prog. SId);
+	      inSchedule	= true;
+	      currentSId	= prog. SId;
+	   }
+	   fprintf (f, "  <programme");
+	   if (prog. id != 0) {
+	      fprintf (f, " id=\"");
+	      writeText (f, getString (prog. id));
+	      fprintf (f, "\"");
+	   }
+	   fprintf (f, " shortId=\"%u\">\n", prog. shortId);
+	   writeElement (f, "   ", "shortName", getString (prog. shortName));
+	   writeElement (f, "   ", "mediumName", getString (prog. mediumName));
+	   writeElement (f, "   ", "longName", getString (prog. longName));
+	   fprintf (f, "   <location>\n    <time time=\"");
+	   writeTime (f, prog. startTime);
+	   fprintf (f, "\" duration=\"");
+	   writeDuration (f, prog. duration);
+	   fprintf (f, "\"/>\n    <bearer id=\"%X\"/>\n   </location>\n",
+	                                                     prog. SId);
+	   if ((prog. shortDescription != 0) ||
+	                          (prog. longDescription != 0)) {
+	      fprintf (f, "   <mediaDescription>\n");
+	      writeElement (f, "    ", "shortDescription",
+	                                 getString (prog. shortDescription));
+	      writeElement (f, "    ", "longDescription",
+	                                 getString (prog. longDescription));
+	      fprintf (f, "   </mediaDescription>\n");
+	   }
+	   fprintf (f, "  </programme>\n");
+	}
+	if (inSchedule)
+	   fprintf (f, " </schedule>\n");
+	fprintf (f, "</epg>\n");
+	return fclose (f) == 0;
+}
+
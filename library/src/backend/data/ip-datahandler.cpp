@@ -21,108 +21,132 @@
  *
  */
 #include	"ip-datahandler.h"
-#include	"radio.h"
+#include	"crc-handler.h"
 
-	ip_dataHandler::ip_dataHandler (RadioInterface *mr,
-	                                bool	show_crcErrors) {
-	connect (this, SIGNAL (writeDatagram (char *, int)),
-	         mr, SLOT (sendDatagram (char *, int)));
-	this	-> show_crcErrors	= show_crcErrors;
-	this	-> crcErrors		= 0;
-	this	-> handledPackets	= 0;
-	connect (this, SIGNAL (show_ipErrors (int)),
-	         mr, SLOT (show_ipErrors (int)));
+//
+//	the one's complement sum of the 16 bit words
+static
+uint32_t	ipSum	(uint32_t sum, const uint8_t *p, int32_t length) {
+	for (int32_t i = 0; i + 1 < length; i += 2)
+	   sum += (p [i] << 8) | p [i + 1];
+	if (length & 01)
+	   sum += p [length - 1] << 8;
+	while (sum >> 16)
+	   sum = (sum & 0xFFFF) + (sum >> 16);
+	return sum;
 }
 
-	ip_dataHandler::~ip_dataHandler (void) {
+	ip_dataHandler::ip_dataHandler (ipSink *theSink) {
+	this	-> theSink	= theSink;
+	this	-> nrPending	= 0;
 }
 
-void	ip_dataHandler::add_mscDatagroup (QByteArray &msc) {
-uint8_t *data		= (uint8_t *)(msc. data ());
-bool	extensionFlag	= getBits_1 (data, 0) != 0;
-bool	crcFlag		= getBits_1 (data, 1) != 0;
-bool	segmentFlag	= getBits_1 (data, 2) != 0;
-bool	userAccessFlag	= getBits_1 (data, 3) != 0;
-int16_t	next		= 16;		// bits
-bool	lastSegment	= false;
-uint16_t segmentNumber	= 0;
-bool transportIdFlag	= false;
-uint16_t transportId	= 0;
-uint8_t	lengthInd;
-int16_t	i;
+	ip_dataHandler::~ip_dataHandler (void) {
+	flush ();
+}
+//
+//	The datagroup comes with one bit per byte, it is packed
+//	in its own buffer, the datagram is not copied
+void	ip_dataHandler::add_mscDatagroup (dataGroup msc) {
+uint8_t	*data;
+int32_t	size;
+int32_t	next		= 2;		// bytes
+bool	extensionFlag;
+bool	crcFlag;
+bool	segmentFlag;
+bool	userAccessFlag;
 
-	if (crcFlag && !check_CRC_bits (data, msc.size ())) 
+	if ((theSink == nullptr) || !theSink -> isActive ())
+	   return;
+	size	= msc. pack ();
+	data	= msc. data ();
+	if (size < 4)
 	   return;
 
-	if (extensionFlag)
-	   next += 16;
-
-	if (segmentFlag) {
-	   lastSegment	= getBits_1 (data, next) != 0;
-	   segmentNumber = getBits (data, next + 1, 15);
-	   next += 16;
+	extensionFlag	= (data [0] & 0x80) != 0;
+	crcFlag		= (data [0] & 0x40) != 0;
+	segmentFlag	= (data [0] & 0x20) != 0;
+	userAccessFlag	= (data [0] & 0x10) != 0;
+	if (crcFlag) {
+	   if (!check_crc16_bytes (data, size - 2))
+	      return;
+	   size -= 2;
 	}
 
+	if (extensionFlag)
+	   next += 2;
+	if (segmentFlag)
+	   next += 2;
 	if (userAccessFlag) {
-	   transportIdFlag	= getBits_1 (data, next + 3);
-	   lengthInd		= getBits_4 (data, next + 4);
-	   next	+= 8;
-	   if (transportIdFlag) {
-	      transportId = getBits (data, next, 16);
-	   }
-	   next	+= lengthInd * 8;
+	   if (next >= size)
+	      return;
+	   next	+= 1 + (data [next] & 0x0F);	// length indicator
 	}
+	if (next >= size)
+	   return;
 
-	uint16_t	ipLength	= 0;
-	int16_t		sizeinBits	=
-	              msc. size () - next - (crcFlag != 0 ? 16 : 0);
-	ipLength = getBits (data, next + 16, 16);
-	if (ipLength < msc. size () / 8) {	// just to be sure
-	   QByteArray ipVector;
-	   ipVector. resize (ipLength);
-	   for (i = 0; i < ipLength; i ++)
-	      ipVector [i] = getBits_8 (data, next + 8 * i);
-	   if ((ipVector [0] >> 4) != 4)
-	      return;	// should be version 4
-	   process_ipVector (ipVector);
-	}
+	if (!process_ipVector (&data [next], size - next,
+	                                 datagrams [nrPending]))
+	   return;
+	pending [nrPending ++]	= std::move (msc);
+	if (nrPending >= IP_MAX_BATCH)
+	   flush ();
 }
+//
+//	At the end of each frame the datagrams found go to the
+//	sink, the datagroups go back to the pool
+void	ip_dataHandler::flush	(void) {
+	if (nrPending == 0)
+	   return;
+	theSink	-> send (datagrams, nrPending);
+	for (int16_t i = 0; i < nrPending; i ++)
+	   pending [i]. release ();
+	nrPending	= 0;
+}
+//
+//	Only IPv4. Other protocols than UDP - and fragments - are
+//	still passed on, they are for a tunnel only
+bool	ip_dataHandler::process_ipVector (const uint8_t *data,
+	                                  int32_t length,
+	                                  ipDatagram &d) {
+int32_t	headerSize;
+int32_t	ipSize;
+int32_t	udpSize;
+const uint8_t	*udp;
 
-void	ip_dataHandler::process_ipVector (QByteArray &v) {
-uint8_t	*data		= (uint8_t *)(v. data ());
-int16_t	headerSize	= data [0] & 0x0F;	// in 32 bits words
-int16_t ipSize		= (data [2] << 8) | data [3];
-uint8_t	protocol	= data [9];
+	if ((length < 20) || ((data [0] >> 4) != 4))
+	   return false;
+	headerSize	= (data [0] & 0x0F) * 4;
+	ipSize		= (data [2] << 8) | data [3];
+	if ((headerSize < 20) || (ipSize < headerSize) || (ipSize > length))
+	   return false;
+	if (ipSum (0, data, headerSize) != 0xFFFF)
+	   return false;
 
-uint32_t checkSum	= 0;
-int16_t	i;
+	d. packet		= data;
+	d. packetLength		= ipSize;
+	d. payload		= nullptr;
+	d. payloadLength	= 0;
+	d. dstPort		= 0;
+	if ((data [9] != 17) ||				// not UDP
+	    ((data [6] & 0x3F) != 0) || (data [7] != 0))	// fragment
+	   return true;
 
-	if (show_crcErrors && ( ++handledPackets >= 100)) {
-	   show_ipErrors (100 - crcErrors);
-	   crcErrors	= 0;
-	   handledPackets	= 0;
-	}
-	for (i = 0; i < 2 * headerSize; i ++)
-	   checkSum +=  ((data [2 * i] << 8) | data [2 * i + 1]);
-	checkSum = (checkSum >> 16) + (checkSum & 0xFFFF);
-	if ((~checkSum & 0xFFFF) != 0) {
-	   crcErrors ++;
-	   return;
-	}
-	   
-	switch (protocol) {
-	   case 17:			// UDP protocol
-	      process_udpVector (&data [4 * headerSize], ipSize - 4 * headerSize);
-	      return;
-	   default:
-	      return;
-	}
-}
+	if (ipSize - headerSize < 8)		// no room for a UDP header
+	   return false;
+	udp	= &data [headerSize];
+	udpSize	= (udp [4] << 8) | udp [5];
+	if ((udpSize < 8) || (udpSize > ipSize - headerSize))
+	   return false;
 //
-//	We keep it simple now, just hand over the data from the
-//	udp packet to port 8888
-void	ip_dataHandler::process_udpVector (uint8_t *data, int16_t length) {
-char *message = (char *)(&(data [8]));
-	   writeDatagram ((char *)message, length - 8);
+//	the UDP checksum - if any - covers a pseudo header too
+	if ((udp [6] != 0) || (udp [7] != 0)) {
+	   uint32_t sum	= ipSum (17 + udpSize, &data [12], 8);
+	   if (ipSum (sum, udp, udpSize) != 0xFFFF)
+	      return false;
+	}
+	d. payload		= &udp [8];
+	d. payloadLength	= udpSize - 8;
+	d. dstPort		= (udp [2] << 8) | udp [3];
+	return true;
 }
-
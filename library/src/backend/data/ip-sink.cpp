@@ -0,0 +1,148 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#include	"ip-sink.h"
+#include	<stdio.h>
+#include	<string.h>
+#include	<errno.h>
+#include	<unistd.h>
+#include	<arpa/inet.h>
+
+	ipSink::ipSink	(void) {
+	socketHandle	= -1;
+	tunnelHandle	= -1;
+	port		= 0;
+	toSocket	= false;
+	active. store (false);
+	memset (&destination, 0, sizeof (destination));
+}
+
+	ipSink::~ipSink	(void) {
+	if (socketHandle >= 0)
+	   close (socketHandle);
+}
+//
+//	an empty address stops the forwarding to the socket
+bool	ipSink::setDestination	(const std::string &address, int port) {
+struct sockaddr_in	a;
+
+	std::lock_guard<std::mutex> lck (locker);
+	if (address == "") {
+	   toSocket	= false;
+	   active. store (tunnelHandle >= 0);
+	   return true;
+	}
+
+	memset (&a, 0, sizeof (a));
+	a. sin_family	= AF_INET;
+	if ((port < 0) || (port > 65535) ||
+	    (inet_pton (AF_INET, address. c_str (), &a. sin_addr) != 1))
+	   return false;
+	if (socketHandle < 0) {
+	   socketHandle	= socket (AF_INET, SOCK_DGRAM, 0);
+	   if (socketHandle < 0)
+	      return false;
+	}
+	destination	= a;
+	this	-> port	= port;
+	toSocket	= true;
+	active. store (true);
+	return true;
+}
+//
+//	the descriptor remains the property of the caller, -1
+//	stops writing to it
+void	ipSink::setTunnel	(int fd) {
+	std::lock_guard<std::mutex> lck (locker);
+	tunnelHandle	= fd;
+	active. store (toSocket || (tunnelHandle >= 0));
+}
+
+bool	ipSink::isActive	(void) {
+	return active. load ();
+}
+//
+//	A tunnel takes complete packets, one write each. For the socket
+//	the UDP payloads of a batch go in a single sendmmsg, the
+//	socket is not waited for: when it is full the rest is dropped
+int32_t	ipSink::send	(const ipDatagram *list, int16_t amount) {
+int32_t	sent	= 0;
+int16_t	n	= 0;
+
+	std::lock_guard<std::mutex> lck (locker);
+	if (tunnelHandle >= 0) {
+	   for (int16_t i = 0; i < amount; i ++)
+	      if (write (tunnelHandle, list [i]. packet,
+	                 list [i]. packetLength) == list [i]. packetLength)
+	         sent ++;
+	   return sent;
+	}
+	if (!toSocket)
+	   return 0;
+
+	for (int16_t i = 0; (i < amount) && (n < IP_MAX_BATCH); i ++) {
+	   if (list [i]. payload == nullptr)	// e.g. not UDP
+	      continue;
+	   addresses [n]	= destination;
+	   addresses [n]. sin_port	= htons (port != 0 ? port :
+	                                           list [i]. dstPort);
+	   vectors [n]. iov_base	= (void *)(list [i]. payload);
+	   vectors [n]. iov_len		= list [i]. payloadLength;
+	   n ++;
+	}
+#ifdef	__linux__
+	for (int16_t i = 0; i < n; i ++) {
+	   memset (&messages [i], 0, sizeof (struct mmsghdr));
+	   messages [i]. msg_hdr. msg_name	= &addresses [i];
+	   messages [i]. msg_hdr. msg_namelen	= sizeof (struct sockaddr_in);
+	   messages [i]. msg_hdr. msg_iov	= &vectors [i];
+	   messages [i]. msg_hdr. msg_iovlen	= 1;
+	}
+	int16_t done	= 0;
+	while (done < n) {
+	   int res	= sendmmsg (socketHandle, &messages [done],
+	                            n - done, MSG_DONTWAIT);
+	   if (res > 0) {
+	      done	+= res;
+	      sent	+= res;
+	   }
+	   else
+	   if ((res < 0) && (errno == EINTR))
+	      continue;
+	   else
+	   if ((res < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+	      break;
+	   else
+	      done ++;		// skip the one that failed
+	}
+#else
+	for (int16_t i = 0; i < n; i ++)
+	   if (sendto (socketHandle, vectors [i]. iov_base,
+	               vectors [i]. iov_len, MSG_DONTWAIT,
+	               (struct sockaddr *)&addresses [i],
+	               sizeof (struct sockaddr_in)) >= 0)
+	      sent ++;
+#endif
+	return sent;
+}
+
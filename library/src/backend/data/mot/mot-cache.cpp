@@ -0,0 +1,74 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#
+#include	"mot-cache.h"
+
+	motCache::motCache	(int16_t size) {
+	this	-> size	= size;
+	clock		= 0;
+	entries. reserve (size);
+}
+
+	motCache::~motCache	(void) {
+}
+
+bool	motCache::contains	(uint16_t transportId,
+	                         const std::string &name, uint16_t headerCrc) {
+	for (auto &e : entries)
+	   if ((e. transportId == transportId) &&
+	       (e. headerCrc == headerCrc) && (e. name == name)) {
+	      e. lastSeen	= ++ clock;
+	      return true;
+	   }
+	return false;
+}
+
+void	motCache::insert	(uint16_t transportId,
+	                         const std::string &name, uint16_t headerCrc) {
+int	oldest	= 0;
+
+	if ((size <= 0) || contains (transportId, name, headerCrc))
+	   return;
+	if ((int)entries. size () < size) {
+	   cacheEntry e;
+	   e. transportId	= transportId;
+	   e. headerCrc		= headerCrc;
+	   e. name		= name;
+	   e. lastSeen		= ++ clock;
+	   entries. push_back (e);
+	   return;
+	}
+	for (int i = 1; i < (int)entries. size (); i ++)
+	   if (entries [i]. lastSeen < entries [oldest]. lastSeen)
+	      oldest = i;
+	entries [oldest]. transportId	= transportId;
+	entries [oldest]. headerCrc	= headerCrc;
+	entries [oldest]. name		= name;
+	entries [oldest]. lastSeen	= ++ clock;
+}
+
+void	motCache::clear		(void) {
+	entries. resize (0);
+}
+
@@ -25,6 +25,8 @@
 #include	"mot-dir.h"
 
 	motDirectory::motDirectory (motdata_t	motdataHandler,
+	                            motSink	*theSink,
+	                            motCache	*theCache,
 	                            void	*ctx,
 	                            uint16_t	transportId,
 	                            int16_t	segmentSize,
@@ -34,6 +36,8 @@
 int16_t	i;
 
 	   this	-> motdataHandler	= motdataHandler;
+	   this	-> theSink		= theSink;
+	   this	-> theCache		= theCache;
 	   this	-> ctx			= ctx;
 	   for (i = 0; i < 512; i ++)
 	      marked [i] = false;
@@ -132,6 +136,8 @@ int16_t	i;
 	      break;
 	   uint8_t *segment	= &data [currentBase + 2];
 	   motObject *handle	= new motObject (motdataHandler,
+	                                         theSink,
+	                                         theCache,
 	                                         true,
 	                                         transportId,
 	                                         segment,
@@ -24,18 +24,13 @@
 #include	"mot-handler.h"
 #include	"mot-object.h"
 #include	"mot-dir.h"
-//
-//	we "cache" the most recent single motSlides (not those in a directory)
-//
-struct {
-	uint16_t	transportId;
-	int32_t		orderNumber;
-	motObject	*motSlide;
-} motTable [15];
+#include	"crc-handler.h"
 
 	motHandler::motHandler (motdata_t motdataHandler,
+	                        motSink	*theSink,
 	                        void	*ctx) {
 	this	-> motdataHandler	= motdataHandler;
+	this	-> theSink		= theSink;
 	this	-> ctx			= ctx;
 	orderNumber		= 0;
 
@@ -48,14 +43,14 @@ struct {
 int	i;
 
 	for (i = 0; i < 15; i ++)
-	   if (motTable [i]. orderNumber > 0)
+	   if (motTable [i]. orderNumber >= 0)
 	      delete motTable [i]. motSlide;
 	if (theDirectory != nullptr)
 	   delete theDirectory;
 }
 
-void	motHandler::add_mscDatagroup (std::vector<uint8_t> msc) {
-uint8_t *data		= (uint8_t *)(msc. data ());
+void	motHandler::add_mscDatagroup (dataGroup msc) {
+uint8_t *data		= msc. data ();
 bool	extensionFlag	= getBits_1 (data, 0) != 0;
 bool	crcFlag		= getBits_1 (data, 1) != 0;
 bool	segmentFlag	= getBits_1 (data, 2) != 0;
@@ -71,13 +66,10 @@ uint8_t	lengthInd;
 int32_t	i;
 
 	(void)CI;
-	if (msc. size () <= 0) {
+	if (msc. size () < 16) {
 	   return;
 	}
 
-	if (crcFlag && !check_CRC_bits (data, msc.size ())) 
-	   return;
-
 	if (extensionFlag)
 	   next += 16;
 
@@ -100,10 +92,21 @@ int32_t	i;
 	int32_t		sizeinBits	=
 	              msc. size () - next - (crcFlag != 0 ? 16 : 0);
 
-	if (!transportIdFlag)
+	if (!transportIdFlag || (sizeinBits < 16))
+	   return;
+//
+//	body segments of an object that is complete - or was recognized
+//	from its header as one completed before - are skipped before
+//	spending time on the crc
+	if (groupType == 4) {
+	   motObject *h = getHandle (transportId);
+	   if ((h == nullptr) || h -> isComplete ())
+	      return;
+	}
+
+	if (crcFlag && !check_crc16_bits (data, msc.size ())) 
 	   return;
 
-	std::vector<uint8_t> motVector;
 	motVector. resize (sizeinBits / 8);
 	for (i = 0; i < sizeinBits / 8; i ++)
 	   motVector [i] = getBits_8 (data, next + 8 * i);
@@ -115,9 +118,15 @@ int32_t	i;
 	   case 3:
 	      if (segmentNumber == 0) {
 	         motObject *h = getHandle (transportId);
-	         if (h != nullptr) 
+//	a header we have seen, nothing changed
+	         if ((h != nullptr) &&
+	             (h -> get_headerCrc () ==
+	                 motObject::headerCrc (&motVector [2],
+	                                       motVector. size () - 2)))
 	            break;
 	         h = new motObject (motdataHandler,
+	                            theSink,
+	                            &theCache,
 	                            false,	// not within a directory
 	                            transportId,
 	                            &motVector [2],	
@@ -162,6 +171,8 @@ int32_t	i;
 //	                        = ((segment [9] & 0x1F) << 8) |
 //	                           segment [10];
 	         theDirectory	= new motDirectory (motdataHandler,
+	                                            theSink,
+	                                            &theCache,
 	                                            ctx,
 	                                            transportId,
 	                                            segmentSize,
@@ -203,6 +214,16 @@ int	i;
 int	oldest	= orderNumber;
 int	index	= 0;
 
+//	a changed object replaces the one with the same transportId
+	for (i = 0; i < 15; i ++)
+	   if ((motTable [i]. orderNumber >= 0) &&
+	       (motTable [i]. transportId == transportId)) {
+	      delete motTable [i]. motSlide;
+	      motTable [i]. orderNumber	= orderNumber ++;
+	      motTable [i]. motSlide	= h;
+	      return;
+	   }
+
 	for (i = 0; i < 15; i ++)
 	   if (motTable [i]. orderNumber == -1) {
 	      motTable [i]. orderNumber = orderNumber ++;
@@ -23,23 +23,32 @@
  *	for handling a single MOT message with a given transportId
  */
 #include	"mot-object.h"
+#include	"mot-sink.h"
+#include	"mot-cache.h"
+#include	"crc-handler.h"
 #include	<cstring>
 
 	   motObject::motObject (motdata_t	motdataHandler,
+	                         motSink	*theSink,
+	                         motCache	*theCache,
 	                         bool		dirElement,
 	                         uint16_t	transportId,
-	                         uint8_t	*segment,
+	                         const uint8_t	*segment,
 	                         int32_t	segmentSize,
 	                         bool		lastFlag,
 	                         void		*ctx) {
 int32_t pointer = 7;
 
 	this	-> motdataHandler	= motdataHandler;
+	this	-> theSink		= theSink;
+	this	-> theCache		= theCache;
 	this	-> dirElement		= dirElement;
 	this	-> transportId		= transportId;
 	this	-> numofSegments	= -1;
 	this	-> segmentSize		= -1;
 	this	-> ctx			= ctx;
+	receivedSegments		= 0;
+	complete			= false;
 	headerSize     =
              ((segment [3] & 0x0F) << 9) |
 	               (segment [4] << 1) | ((segment [5] >> 7) & 0x01);
@@ -86,11 +95,42 @@ int32_t pointer = 7;
                  pointer += length;
            }
 	}
+//
+//	an object seen (and delivered) before is complete from the start,
+//	its body segments will be ignored
+	theHeaderCrc	= headerCrc (segment, segmentSize);
+	if ((theCache != nullptr) &&
+	    theCache -> contains (transportId, name, theHeaderCrc))
+	   complete	= true;
 }
 
 	motObject::~motObject	(void) {
 }
 
+//
+//	The header is the first headerSize bytes of the header segment,
+//	for objects from a directory the segmentSize is not known (-1)
+uint16_t	motObject::headerCrc (const uint8_t *segment,
+	                              int32_t segmentSize) {
+uint32_t	headerSize;
+
+	if ((segmentSize >= 0) && (segmentSize < 7))
+	   return 0;
+	headerSize	= ((segment [3] & 0x0F) << 9) |
+	               (segment [4] << 1) | ((segment [5] >> 7) & 0x01);
+	if ((segmentSize >= 0) && ((int32_t)headerSize > segmentSize))
+	   headerSize	= segmentSize;
+	return crc16_bytes (segment, headerSize);
+}
+
+uint16_t	motObject::get_headerCrc	(void) {
+	return theHeaderCrc;
+}
+
+bool	motObject::isComplete		(void) {
+	return complete;
+}
+
 uint16_t	motObject::get_transportId (void) {
 	return transportId;
 }
@@ -99,80 +139,64 @@ uint16_t	motObject::get_transportId (void) {
 //	The pad/dir software will only call this whenever it has
 //	established that the current slide has th right transportId
 //
-//	Note that segments do not need to come in in the right order
-void	motObject::addBodySegment (uint8_t	*bodySegment,
+//	Note that segments do not need to come in in the right order.
+//	All segments but the last one have the same size, so segment n
+//	starts at n * segmentSize, the last one ends at bodySize
+void	motObject::addBodySegment (const uint8_t	*bodySegment,
 	                           int16_t	segmentNumber,
 	                           int32_t	segmentSize,
 	                           bool		lastFlag) {
-int32_t i;
+int32_t	offset;
 
 	if ((segmentNumber < 0) || (segmentNumber >= 8192))
 	   return;
+	if (complete || (segmentSize <= 0) ||
+	    (bodySize == 0) || (bodySize > MAX_MOT_BODY))
+	   return;
 
-        if (motMap. find (segmentNumber) != motMap. end ())
-           return;
-
+	if (body. size () == 0) {
+	   body. resize (bodySize);
+	   received. resize (8192 / 64, 0);
+	}
+	if ((received [segmentNumber / 64] >> (segmentNumber % 64)) & 01)
+	   return;
 
 //      Note that the last segment may have a different size
         if (!lastFlag && (this -> segmentSize == -1))
            this -> segmentSize = segmentSize;
 
-	std::vector<uint8_t> segment;
-	segment. resize (segmentSize);
-	for (i = 0; i < segmentSize; i ++)
-	   segment [i] = bodySegment [i];
-        motMap. insert (std::make_pair (segmentNumber, segment));
+	if (lastFlag)
+	   offset = bodySize - segmentSize;
+	else {
+	   if (segmentSize != this -> segmentSize)
+	      return;		// inconsistent, ignore
+	   offset = segmentNumber * segmentSize;
+	}
+	if ((offset < 0) || (offset + segmentSize > (int32_t)bodySize))
+	   return;
+
+	memcpy (&body [offset], bodySegment, segmentSize);
+	received [segmentNumber / 64] |= ((uint64_t)1) << (segmentNumber % 64);
+	receivedSegments ++;
 //
         if (lastFlag)
            numofSegments = segmentNumber + 1;
 
-	if (numofSegments == -1)
-	   return;
-//
-//      once we know how many segments there are/should be,
-//      we check for completeness
-        for (i = 0; i < numofSegments; i ++) {
-           if (motMap. find (i) == motMap. end ())
-              return;
-        }
-
-//      The motObject is (seems to be) complete
-        handleComplete ();
+	if ((numofSegments != -1) && (receivedSegments == numofSegments))
+	   handleComplete ();
 }
-
-
-void	motObject::handleComplete (void) {
-std::vector<uint8_t> result;
-
-        for (const auto &it : motMap)
-	   result. insert (result. end (),
-	                   (it. second). begin (),
-	                   (it. second). end ());
-
-	if (contentType == 7) {		// epg data
-	   return;
-	}
 //
-//	Only send the picture to show when it is a slide and not
-//	an element of a directory
-	if (contentType != 2) {
-	   return;
-	}
-
-	std::string realName;
-
-//	MOT slide, to show
-	if (motdataHandler != nullptr) {
-	   if (name == "")
-	      realName = "no name";
-           else
-	      realName = name;
-	   realName = "/tmp/" + realName;
-	   FILE * temp = fopen (realName. c_str (), "w");
-	   fwrite (result.data (), 1, result. size (), temp);
-	   fclose (temp);
-	   motdataHandler (realName, contentsubType, ctx);
-	}
+//	The motObject is complete, the body is passed on to the sink,
+//	which takes it over
+void	motObject::handleComplete (void) {
+	complete	= true;
+	std::vector<uint64_t> (). swap (received);
+	if (theCache != nullptr)
+	   theCache -> insert (transportId, name, theHeaderCrc);
+	if (theSink != nullptr)
+	   theSink -> deliver (motdataHandler, ctx,
+	                       name, contentType, contentsubType, body);
+	std::vector<uint8_t> (). swap (body);
 }
 
 int     motObject::get_headerSize       (void) {
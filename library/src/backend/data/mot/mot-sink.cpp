@@ -0,0 +1,144 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#
+#include	"mot-sink.h"
+#include	"epg-decoder.h"
+#include	<stdio.h>
+
+	motSink::motSink	(void) {
+	objectHandler	= nullptr;
+	theEPG		= nullptr;
+	objectCtx	= nullptr;
+	writeFiles	= true;
+	busy		= false;
+	stopping	= false;
+	started		= false;
+}
+//
+//	files still queued are written before the thread stops
+	motSink::~motSink	(void) {
+	std::unique_lock<std::mutex> lck (locker);
+	stopping	= true;
+	lck. unlock ();
+	jobAvailable. notify_all ();
+	if (started)
+	   threadHandle. join ();
+}
+
+void	motSink::setObjectHandler	(motObject_t	objectHandler,
+	                                 void		*objectCtx,
+	                                 bool		writeFiles) {
+	std::lock_guard<std::mutex> lck (locker);
+	this	-> objectHandler	= objectHandler;
+	this	-> objectCtx		= objectCtx;
+	this	-> writeFiles		= writeFiles;
+}
+
+//
+//	to be set before objects are delivered
+void	motSink::setEPGDecoder	(epgDecoder *theEPG) {
+	this	-> theEPG	= theEPG;
+}
+
+void	motSink::deliver	(motdata_t	motdataHandler,
+	                         void		*ctx,
+	                         const std::string &name,
+	                         int		contentType,
+	                         int		contentsubType,
+	                         std::vector<uint8_t> &body) {
+motObject_t	handler;
+void		*handlerCtx;
+bool		toFile;
+
+	locker. lock ();
+	handler		= objectHandler;
+	handlerCtx	= objectCtx;
+	toFile		= writeFiles;
+	locker. unlock ();
+
+	if (handler != nullptr)
+	   handler (name, contentType, contentsubType,
+	            body. data (), body. size (), handlerCtx);
+	if ((contentType == 7) && (theEPG != nullptr))
+	   theEPG -> decode (body. data (), body. size (), name);
+//
+//	Only slides go to a file, and only when there is someone
+//	to tell
+	if (!toFile || (contentType != 2) || (motdataHandler == nullptr)) {
+	   std::vector<uint8_t> (). swap (body);
+	   return;
+	}
+
+	std::unique_lock<std::mutex> lck (locker);
+	if (stopping) {
+	   std::vector<uint8_t> (). swap (body);
+	   return;
+	}
+	fileJob	job;
+	job. name		= name == "" ? "no name" : name;
+	job. contentsubType	= contentsubType;
+	job. motdataHandler	= motdataHandler;
+	job. ctx		= ctx;
+	job. body. swap (body);
+	jobs. push_back (std::move (job));
+	if (!started) {
+	   threadHandle	= std::thread (&motSink::run, this);
+	   started	= true;
+	}
+	lck. unlock ();
+	jobAvailable. notify_one ();
+}
+
+void	motSink::flush	(void) {
+	std::unique_lock<std::mutex> lck (locker);
+	while ((jobs. size () > 0) || busy)
+	   jobsDone. wait (lck);
+}
+
+void	motSink::run	(void) {
+	std::unique_lock<std::mutex> lck (locker);
+	while (true) {
+	   while ((jobs. size () == 0) && !stopping)
+	      jobAvailable. wait (lck);
+	   if (jobs. size () == 0)	// and stopping
+	      break;
+	   fileJob job	= std::move (jobs. front ());
+	   jobs. pop_front ();
+	   busy	= true;
+	   lck. unlock ();
+
+	   std::string realName = "/tmp/" + job. name;
+	   FILE *temp	= fopen (realName. c_str (), "w");
+	   if (temp != nullptr) {
+	      fwrite (job. body. data (), 1, job. body. size (), temp);
+	      fclose (temp);
+	      job. motdataHandler (realName, job. contentsubType, job. ctx);
+	   }
+
+	   lck. lock ();
+	   busy	= false;
+	   jobsDone. notify_all ();
+	}
+}
+
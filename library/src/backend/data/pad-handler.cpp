@@ -23,14 +23,18 @@
 #include	<cstring>
 #include	"charsets.h"
 #include	"mot-object.h"
+#include	"crc-handler.h"
 /**
   *	\class padHandler
   *	Handles the pad segments passed on from mp2- and mp4Processor
   */
 	padHandler::padHandler	(dataOut_t dataOut,
-	                         motdata_t motdata_Handler, void *ctx) {
+	                         motdata_t motdata_Handler,
+	                         motSink *theSink, void *ctx):
+	                                          groupPool (2048) {
 	this	-> dataOut		= dataOut;
 	this	-> motdata_Handler	= motdata_Handler;
+	this	-> theSink		= theSink;
 	this	-> ctx			= ctx;
 //
 //	mscGroupElement indicates whether we are handling an
@@ -42,6 +46,12 @@
 //	xpadfields, needed for handling xpads without CI's
 	xpadLength	= -1;
 	still_to_go	= 0;
+//
+//	state of the dynamic label assembly
+	segmentno		= 0;
+	remainDataLength	= 0;
+	isLastSegment		= false;
+	moreXPad		= false;
 	lastSegment	= false;
 	firstSegment	= false;
 	segmentNumber	= -1;
@@ -161,7 +171,7 @@ int16_t	i;
 //
 //	Here we end up when F_PAD type = 00 and X-PAD Ind = 02
 static
-int16_t	lengthTable [] = {4, 6, 8, 12, 16, 24, 32, 48};
+const int16_t	lengthTable [] = {4, 6, 8, 12, 16, 24, 32, 48};
 
 //
 //	Since the data is reversed, we pass on the vector address
@@ -173,17 +183,16 @@ int16_t	CI_Index = 0;
 uint8_t CI_table [4];
 int16_t	i, j;
 int16_t	base	= last;	
-std::vector<uint8_t> data;
+uint8_t	data [4 * 48 + 4];	// max xpadLength
 
 //	If an xpadfield shows with a CI_flag == 0, and if we are
 //	dealing with an msc field, the size to be taken is
 //	the size of the latest xpadfield that had a CI_flag != 0
 	if (CI_flag == 0) {
 	   if (mscGroupElement && (xpadLength > 0)) {
-	      data. resize (xpadLength);
 	      for (j = 0; j < xpadLength; j ++)
 	         data [j] = b [last - j];
-	      add_MSC_element (data);
+	      add_MSC_element (data, xpadLength);
 	   }
 	   return;
 	}
@@ -219,7 +228,6 @@ std::vector<uint8_t> data;
 	   }
 
 //	collect data, reverse the reversed bytes
-	   data. resize (length);
 	   for (j = 0; j < length; j ++)  
 	      data [j] = b [base - j];
 
@@ -229,16 +237,15 @@ std::vector<uint8_t> data;
 
 	      case 2:
 	      case 3:
-	         dynamicLabel ((uint8_t *)(data. data ()),
-	                        data. size (), CI_table [i]);
+	         dynamicLabel (data, length, CI_table [i]);
 	         break;
 
 	      case 12:
-	         new_MSC_element (data);
+	         new_MSC_element (data, length);
 	         break;
 
  	      case 13:
-	         add_MSC_element (data);
+	         add_MSC_element (data, length);
 	         break;
 	   }
 
@@ -254,10 +261,6 @@ std::vector<uint8_t> data;
 //	A dynamic label is created from a sequence of (dynamic) xpad
 //	fields, starting with CI = 2, continuing with CI = 3
 void	padHandler::dynamicLabel (uint8_t *data, int16_t length, uint8_t CI) {
-static int16_t segmentno           = 0;
-static int16_t remainDataLength    = 0;
-static bool    isLastSegment       = false;
-static bool moreXPad	= false;
 int16_t  dataLength	= 0;
 
 	(void)segmentno;
@@ -340,11 +343,12 @@ int16_t  dataLength	= 0;
 //
 //	Called at the start of the msc datagroupfield,
 //	the msc_length was given by the preceding appType "1"
-void	padHandler::new_MSC_element (std::vector<uint8_t> data) {
+void	padHandler::new_MSC_element (const uint8_t *data, int16_t length) {
 
-	if ((int)data. size () >= dataGroupLength) {
+	if (length >= dataGroupLength) {
 //	   msc element is single item
-	   build_MSC_segment (data);
+	   build_MSC_segment (data, length);
+	   msc_dataGroupBuffer. release ();
 	   mscGroupElement = false;
 //	   show_motHandling (true);
 //         fprintf (stderr, "msc element is single\n");
@@ -352,13 +356,15 @@ void	padHandler::new_MSC_element (std::vector<uint8_t> data) {
 	}
 
 	mscGroupElement		= true;
+	if (!msc_dataGroupBuffer. isValid ())
+	   msc_dataGroupBuffer	= groupPool. get ();
 	msc_dataGroupBuffer. clear ();
-	msc_dataGroupBuffer     = data;
+	msc_dataGroupBuffer. append (data, length);
 //	show_motHandling (true);
 }
 
 //
-void	padHandler::add_MSC_element	(std::vector<uint8_t> data) {
+void	padHandler::add_MSC_element	(const uint8_t *data, int16_t length) {
 int32_t currentLength = msc_dataGroupBuffer. size ();
 //
 //      just to ensure that, when a "12" appType is missing, the
@@ -367,23 +373,21 @@ int32_t currentLength = msc_dataGroupBuffer. size ();
 	   return;
 	}
 
-	msc_dataGroupBuffer. insert (std::end (msc_dataGroupBuffer),
-	                             std::begin (data), std::end (data));
-	if ((int)(msc_dataGroupBuffer. size ()) >= dataGroupLength) {
-	   build_MSC_segment (msc_dataGroupBuffer);
-	   msc_dataGroupBuffer. clear ();
+	msc_dataGroupBuffer. append (data, length);
+	if (msc_dataGroupBuffer. size () >= dataGroupLength) {
+	   build_MSC_segment (msc_dataGroupBuffer. data (),
+	                      msc_dataGroupBuffer. size ());
+	   msc_dataGroupBuffer. release ();
 	   mscGroupElement      = false;
 //	   show_motHandling (false);
 	}
 }
 
-void	padHandler::build_MSC_segment (std::vector<uint8_t> data) {
+void	padHandler::build_MSC_segment (const uint8_t *data, int32_t length) {
 //	we have a MOT segment, let us look what is in it
 //	according to DAB 300 401 (page 37) the header (MSC data group)
 //	is
-int32_t size    = (int)(data. size ()) <
-	                 dataGroupLength ? data. size () :
-                                                    dataGroupLength;
+int32_t size    = length < dataGroupLength ? length : dataGroupLength;
 
 	uint8_t		groupType	=  data [0] & 0xF;
 	uint8_t		continuityIndex = (data [1] & 0xF) >> 4;
@@ -395,7 +399,7 @@ int32_t size    = (int)(data. size ()) <
 
 	(void)continuityIndex; (void)repetitionIndex;
 	if ((data [0] & 0x40) != 0) {
-	   bool res	= check_crc_bytes (data. data (), size - 2);
+	   bool res	= check_crc16_bytes (data, size - 2);
 	   if (!res) {
 //	      fprintf (stderr, "crc failed ");
 	      return;
@@ -443,6 +447,8 @@ int32_t size    = (int)(data. size ()) <
 	      if (currentSlide == nullptr) {
 //	         fprintf (stderr, "creating %d\n", (uint32_t)transportId);
 	         currentSlide   = new motObject (motdata_Handler,
+	                                         theSink,
+	                                         &theCache,
 	                                         false,
 	                                         transportId,
 	                                         &data [index + 2],
@@ -451,13 +457,19 @@ int32_t size    = (int)(data. size ()) <
 	                                         ctx);
 	      }
 	     else {
-	         if (currentSlide -> get_transportId () == transportId)
+//	the same object, and not changed
+	         if ((currentSlide -> get_transportId () == transportId) &&
+	             (currentSlide -> get_headerCrc () ==
+	                 motObject::headerCrc (&data [index + 2],
+	                                       size - index - 2)))
 	            break;
 //	         fprintf (stderr, "out goes %u, in comes %u\n",
 //	                  currentSlide -> get_transportId (),
 //	                  (uint32_t)transportId);
 	         delete currentSlide;
 	         currentSlide   = new motObject (motdata_Handler,
+	                                         theSink,
+	                                         &theCache,
 	                                         false,
 	                                         transportId,
 	                                         &data [index + 2],
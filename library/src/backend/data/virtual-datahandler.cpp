@@ -29,7 +29,15 @@
 	virtual_dataHandler::~virtual_dataHandler (void) {
 }
 
-void	virtual_dataHandler::add_mscDatagroup (std::vector<uint8_t> m) {
+void	virtual_dataHandler::add_mscDatagroup (dataGroup m) {
 	(void)m;
 }
 
+void	virtual_dataHandler::flush	(void) {
+}
+
+void	virtual_dataHandler::getStats	(int32_t &frames, int32_t &errors) {
+	frames	= 0;
+	errors	= 0;
+}
+
@@ -0,0 +1,363 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#include	<algorithm>
+#include	"full-ensemble.h"
+#include	"msc-handler.h"
+#include	"fic-handler.h"
+
+	fullEnsembleHandler::fullEnsembleHandler (mscHandler *theMsc,
+	                                          ficHandler *theFic) {
+	this	-> theMsc	= theMsc;
+	this	-> theFic	= theFic;
+	this	-> userData	= nullptr;
+	memset (&callbacks, 0, sizeof (callbacks));
+	active. store (false);
+	attached. store (false);
+	lastVersion. store (0);
+	pending		= false;
+	stopping	= false;
+	started		= false;
+}
+
+	fullEnsembleHandler::~fullEnsembleHandler (void) {
+	std::unique_lock<std::mutex> lck (signalLocker);
+	stopping	= true;
+	lck. unlock ();
+	changeSignal. notify_all ();
+	if (started)
+	   controlThread. join ();
+	stop ();
+}
+//
+//	the backends are added by the control thread, once the
+//	processor thread tells that there is an ensemble
+void	fullEnsembleHandler::start (serviceCallbacks *cb, void *userData) {
+	locker. lock ();
+	removeRoutes ();
+	callbacks	= *cb;
+	this	-> userData	= userData;
+	attached. store (false);
+	active. store (true);
+	locker. unlock ();
+	std::lock_guard<std::mutex> lck (signalLocker);
+	if (!started) {
+	   controlThread	= std::thread (&fullEnsembleHandler::run, this);
+	   started	= true;
+	}
+}
+
+void	fullEnsembleHandler::stop	(void) {
+	locker. lock ();
+	active. store (false);
+	removeRoutes ();
+	locker. unlock ();
+}
+//
+//	Called by the processor thread, once per frame, so it just
+//	compares and - if needed - wakes up the control thread
+void	fullEnsembleHandler::ensembleChanged	(uint32_t version) {
+	if (!active. load ())
+	   return;
+	if (attached. load () && (version == lastVersion. load ()))
+	   return;
+	std::lock_guard<std::mutex> lck (signalLocker);
+	attached. store (true);
+	lastVersion. store (version);
+	pending	= true;
+	changeSignal. notify_one ();
+}
+
+void	fullEnsembleHandler::run	(void) {
+std::vector<serviceDescriptor> serviceList;
+
+	std::unique_lock<std::mutex> lck (signalLocker);
+	while (true) {
+	   while (!pending && !stopping)
+	      changeSignal. wait (lck);
+	   if (stopping)
+	      break;
+	   pending	= false;
+	   lck. unlock ();
+	   theFic	-> get_serviceList (serviceList);
+	   update (serviceList);
+	   lck. lock ();
+	}
+}
+//
+//	reset is called when the msc handler is to be reset:
+//	our backends are removed first, and the reset itself is
+//	done under our lock, so an update cannot add a backend
+//	that is deleted behind our back. The backends are added again
+//	after the next ensembleChanged
+void	fullEnsembleHandler::reset	(void) {
+	locker. lock ();
+	attached. store (false);
+	removeRoutes ();
+	theMsc	-> reset ();
+	locker. unlock ();
+}
+//
+//	clear is called from the processor thread, just before the
+//	msc handler stops (and deletes all backends). Until the thread
+//	calls ensembleChanged again, no backends are added
+void	fullEnsembleHandler::clear	(void) {
+	locker. lock ();
+	attached. store (false);
+	removeRoutes ();
+	locker. unlock ();
+}
+
+void	fullEnsembleHandler::removeRoutes	(void) {
+	for (auto const &r : routes) {
+	   theMsc	-> remove_channel (r -> channel);
+	   delete r;
+	}
+	routes. resize (0);
+}
+
+bool	fullEnsembleHandler::sameParameters (serviceRoute *r,
+	                                     serviceDescriptor &d) {
+	if ((r -> SId != d. SId) || (r -> componentNr != d. componentNr) ||
+	    (r -> isAudio != d. isAudio))
+	   return false;
+	if (r -> isAudio)
+	   return (r -> ad. subchId	== d. ad. subchId) &&
+	          (r -> ad. startAddr	== d. ad. startAddr) &&
+	          (r -> ad. length	== d. ad. length) &&
+	          (r -> ad. shortForm	== d. ad. shortForm) &&
+	          (r -> ad. protLevel	== d. ad. protLevel) &&
+	          (r -> ad. bitRate	== d. ad. bitRate) &&
+	          (r -> ad. ASCTy	== d. ad. ASCTy);
+	return (r -> pd. subchId	== d. pd. subchId) &&
+	       (r -> pd. startAddr	== d. pd. startAddr) &&
+	       (r -> pd. length		== d. pd. length) &&
+	       (r -> pd. shortForm	== d. pd. shortForm) &&
+	       (r -> pd. protLevel	== d. pd. protLevel) &&
+	       (r -> pd. bitRate	== d. pd. bitRate) &&
+	       (r -> pd. DSCTy		== d. pd. DSCTy) &&
+	       (r -> pd. FEC_scheme	== d. pd. FEC_scheme) &&
+	       (r -> pd. DGflag		== d. pd. DGflag) &&
+	       (r -> pd. packetAddress	== d. pd. packetAddress);
+}
+
+void	fullEnsembleHandler::addRoute	(serviceDescriptor &d) {
+serviceRoute *r	= new serviceRoute;
+
+	r	-> owner	= this;
+	r	-> SId		= d. SId;
+	r	-> componentNr	= d. componentNr;
+	r	-> isAudio	= d. isAudio;
+	r	-> ad		= d. ad;
+	r	-> pd		= d. pd;
+	std::atomic_store (&r -> sharedBy,
+	             std::shared_ptr<const std::vector<int32_t>> (
+	                                 new std::vector<int32_t> ()));
+	r	-> samplesOut. store (0);
+	r	-> bytesOut. store (0);
+	r	-> frameQuality. store (0);
+	r	-> rsQuality. store (0);
+	r	-> aacQuality. store (0);
+	if (d. isAudio)
+	   r -> channel = theMsc -> add_audioChannel (&r -> ad,
+	                                              audioOut, dataOut,
+	                                              programQuality,
+	                                              motdata,
+	                                              AUDIO_OUT_PCM, r);
+	else
+	   r -> channel = theMsc -> add_dataChannel (&r -> pd,
+	                                             bytesOut, motdata, r);
+	routes. push_back (r);
+}
+//
+//	The list is the current view of the FIC on the ensemble.
+//	Routes that are not in the list, or are in the list with
+//	different parameters, are removed; descriptors without a route
+//	get one. An audio subchannel is decoded only once, even if it
+//	is shared by more services, the SIds of the others are
+//	recorded with the route that decodes it.
+void	fullEnsembleHandler::update (std::vector<serviceDescriptor> &list) {
+uint16_t	i, j;
+std::vector<bool> matched (list. size (), false);
+
+	if (!active. load ())
+	   return;
+	locker. lock ();
+	if (!active. load () || !attached. load ()) {
+	   locker. unlock ();
+	   return;
+	}
+
+	for (i = 0; i < routes. size ();) {
+	   bool found	= false;
+	   for (j = 0; j < list. size (); j ++)
+	      if (!matched [j] && sameParameters (routes [i], list [j])) {
+	         matched [j]	= true;
+	         found		= true;
+	         break;
+	      }
+	   if (found) {
+	      i ++;
+	      continue;
+	   }
+	   theMsc	-> remove_channel (routes [i] -> channel);
+	   delete routes [i];
+	   routes. erase (routes. begin () + i);
+	}
+
+	for (auto const &r : routes)
+	   r -> sharers. resize (0);
+	for (j = 0; j < list. size (); j ++) {
+	   serviceRoute *owner	= nullptr;
+	   if (matched [j])
+	      continue;
+	   if (list [j]. isAudio)
+	      for (i = 0; i < routes. size (); i ++)
+	         if (routes [i] -> isAudio &&
+	             (routes [i] -> ad. subchId == list [j]. ad. subchId)) {
+	            owner = routes [i];
+	            break;
+	         }
+	   if (owner == nullptr)
+	      addRoute (list [j]);
+	   else
+	   if ((owner -> SId != list [j]. SId) &&
+	       (std::find (owner -> sharers. begin (), owner -> sharers. end (),
+	                   list [j]. SId) == owner -> sharers. end ()))
+	      owner -> sharers. push_back (list [j]. SId);
+	}
+//
+//	a new list of sharing services is published only if it changed
+	for (auto const &r : routes)
+	   if (*std::atomic_load (&r -> sharedBy) != r -> sharers)
+	      std::atomic_store (&r -> sharedBy,
+	                std::shared_ptr<const std::vector<int32_t>> (
+	                            new std::vector<int32_t> (r -> sharers)));
+	locker. unlock ();
+}
+
+//
+//	A route decoding for more services gives an entry for each of them
+int	fullEnsembleHandler::getStats	(serviceStats *s, int max) {
+int	n	= 0;
+int	total	= 0;
+
+	locker. lock ();
+	for (auto const &r : routes) {
+	   auto shared	= std::atomic_load (&r -> sharedBy);
+	   total	+= 1 + shared -> size ();
+	   if (n >= max)
+	      continue;
+	   s [n]. SId		= r -> SId;
+	   s [n]. isAudio	= r -> isAudio;
+	   s [n]. subchId	= r -> isAudio ? r -> ad. subchId :
+	                                         r -> pd. subchId;
+	   s [n]. bitRate	= r -> isAudio ? r -> ad. bitRate :
+	                                         r -> pd. bitRate;
+	   s [n]. samplesOut	= r -> samplesOut. load ();
+	   s [n]. bytesOut	= r -> bytesOut. load ();
+	   s [n]. frameQuality	= r -> frameQuality. load ();
+	   s [n]. rsQuality	= r -> rsQuality. load ();
+	   s [n]. aacQuality	= r -> aacQuality. load ();
+	   theMsc -> getChannelStats (r -> channel,
+	                              s [n]. framesOut, s [n]. frameErrors);
+	   n ++;
+	   for (auto SId : *shared) {
+	      if (n >= max)
+	         break;
+	      s [n]	= s [n - 1];
+	      s [n]. SId	= SId;
+	      n ++;
+	   }
+	}
+	locker. unlock ();
+	return total;
+}
+//
+//	The callbacks of the backends get the route as context,
+//	they are called from the backend worker threads
+void	fullEnsembleHandler::audioOut (int16_t *b, int size,
+	                               int rate, bool stereo, void *ctx) {
+serviceRoute *r	= static_cast<serviceRoute *>(ctx);
+fullEnsembleHandler *h	= r -> owner;
+
+	r	-> samplesOut. fetch_add (size);
+	if (h -> callbacks. audioOut == nullptr)
+	   return;
+	h -> callbacks. audioOut (r -> SId, b, size, rate, stereo,
+	                                             h -> userData);
+	for (auto SId : *std::atomic_load (&r -> sharedBy))
+	   h -> callbacks. audioOut (SId, b, size, rate, stereo,
+	                                             h -> userData);
+}
+
+void	fullEnsembleHandler::dataOut	(std::string s, void *ctx) {
+serviceRoute *r	= static_cast<serviceRoute *>(ctx);
+fullEnsembleHandler *h	= r -> owner;
+
+	if (h -> callbacks. dataOut == nullptr)
+	   return;
+	h -> callbacks. dataOut (r -> SId, s, h -> userData);
+	for (auto SId : *std::atomic_load (&r -> sharedBy))
+	   h -> callbacks. dataOut (SId, s, h -> userData);
+}
+
+void	fullEnsembleHandler::bytesOut (uint8_t *b, int16_t amount,
+	                               uint8_t type, void *ctx) {
+serviceRoute *r	= static_cast<serviceRoute *>(ctx);
+fullEnsembleHandler *h	= r -> owner;
+
+	r	-> bytesOut. fetch_add (amount);
+	if (h -> callbacks. bytesOut != nullptr)
+	   h -> callbacks. bytesOut (r -> SId, b, amount, type,
+	                                             h -> userData);
+}
+
+void	fullEnsembleHandler::programQuality (int16_t fe, int16_t rs,
+	                                     int16_t aac, void *ctx) {
+serviceRoute *r	= static_cast<serviceRoute *>(ctx);
+fullEnsembleHandler *h	= r -> owner;
+
+	r	-> frameQuality. store (fe);
+	r	-> rsQuality. store (rs);
+	r	-> aacQuality. store (aac);
+	if (h -> callbacks. programQuality == nullptr)
+	   return;
+	h -> callbacks. programQuality (r -> SId, fe, rs, aac,
+	                                             h -> userData);
+	for (auto SId : *std::atomic_load (&r -> sharedBy))
+	   h -> callbacks. programQuality (SId, fe, rs, aac,
+	                                             h -> userData);
+}
+
+void	fullEnsembleHandler::motdata	(std::string s, int d, void *ctx) {
+serviceRoute *r	= static_cast<serviceRoute *>(ctx);
+fullEnsembleHandler *h	= r -> owner;
+
+	if (h -> callbacks. motdata == nullptr)
+	   return;
+	h -> callbacks. motdata (r -> SId, s, d, h -> userData);
+	for (auto SId : *std::atomic_load (&r -> sharedBy))
+	   h -> callbacks. motdata (SId, s, d, h -> userData);
+}
+
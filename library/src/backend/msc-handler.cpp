@@ -36,10 +36,7 @@
 #define	CUSize	(4 * 16)
 //	Note CIF counts from 0 .. 3
 
-static
-int16_t	cifVector [55296];
-
-static int blocksperCIF [] = {18, 72, 0, 36};
+static const int blocksperCIF [] = {18, 72, 0, 36};
 
 		mscHandler::mscHandler	(uint8_t	dabMode,
 	                                 audioOut_t	soundOut,
@@ -51,7 +48,9 @@ static int blocksperCIF [] = {18, 72, 0, 36};
 	                                    params (dabMode),
 	                                    my_fftHandler (dabMode),
 	                                    myMapper (dabMode),
-	                                    freeSlots (params. get_L ()) {
+	                                    freeSlots (params. get_L ()),
+	                                    cifs (2 * params. get_carriers () *
+	                                          blocksperCIF [(dabMode - 1) & 03]) {
 	this	-> soundOut		= soundOut;
 	this	-> dataOut		= dataOut;
 	this	-> bytesOut		= bytesOut;
@@ -72,10 +71,13 @@ static int blocksperCIF [] = {18, 72, 0, 36};
 	work_to_do. store (false);
 	running. store (false);
 	phaseReference. resize (params. get_T_u ());
+	theMotSink. setEPGDecoder (&theEPG);
+	thePool			= backendPool::acquire ();
 }
 
 	mscHandler::~mscHandler	(void) {
 	stop ();
+	backendPool::release ();
 	for (int i = 0; i < params. get_L (); i ++)
 	   delete [] theData [i];
 	delete [] theData;
@@ -87,6 +89,7 @@ void	mscHandler::stop (void) {
 	   threadHandle. join ();
 	}
 
+	clearHistory ();
 	mutexer. lock ();
 	for (auto const &b : theBackends) {
 	   b -> stopRunning ();
@@ -94,8 +97,12 @@ void	mscHandler::stop (void) {
 	}
 
 	theBackends. resize (0);
+	for (auto const &c : theChannels)
+	   delete c;
+	theChannels. resize (0);
 	work_to_do. store (false);
 	mutexer. unlock ();
+	theMotSink. flush ();
 }
 
 void	mscHandler::start	(void) {
@@ -108,9 +115,36 @@ void	mscHandler::start	(void) {
 	threadHandle = std::thread (&mscHandler::run, this);
 }
 
+//
+//	reset removes all channels and backends, but the thread - and
+//	the CIF history - remain, so a service selected next will
+//	produce output with the next CIF
 void	mscHandler::reset	(void) {
-	stop ();
-	start ();
+std::vector<virtualBackend *> oldBackends;
+
+	mutexer. lock ();
+	oldBackends. swap (theBackends);
+	for (auto const &c : theChannels)
+	   delete c;
+	theChannels. resize (0);
+	work_to_do. store (false);
+	mutexer. unlock ();
+
+	for (auto const &b : oldBackends) {
+	   b -> stopRunning ();
+	   delete b;
+	}
+//	no motdata_t call for a removed channel after returning
+	theMotSink. flush ();
+}
+
+void	mscHandler::clearHistory	(void) {
+	mutexer. lock ();
+	for (auto const &c : cifHistory)
+	   c -> unref ();
+	cifHistory. resize (0);
+	mutexer. unlock ();
+	theEPG. clear ();
 }
 
 //	The exteral world sees this
@@ -126,17 +160,22 @@ void    mscHandler::process_mscBlock (std::complex<float> *b, int16_t blkno) {
 	usedSlots. Release ();
 }
 
+//
+//	The soft bits of the msc blocks are written directly into
+//	the CIF buffer, a complete CIF is passed on by reference
 void	mscHandler::run       (void) {
 int	currentBlock	= 0;
-std::vector<int16_t> ibits;
+int8_t	*ibits;
 
 	running. store (true);
 	fft_buffer	= my_fftHandler. getVector ();
-	ibits. resize (BitsperBlock);
+	currentCif	= cifs. get ();
 	while (running. load ()) {
 	   while (!usedSlots. tryAcquire (200))
 	      if (!running)
-	         return;
+	         break;
+	   if (!running)
+	      break;
 	   memcpy (fft_buffer, theData [currentBlock],
 	                 params. get_T_u () * sizeof (std::complex<float>));
 
@@ -144,6 +183,8 @@ std::vector<int16_t> ibits;
 //      "our" msc blocks start with blkno 4
 	   my_fftHandler. do_FFT ();
 	   if (currentBlock >= 4) {
+	      int16_t currentblk = (currentBlock - 4) % numberofblocksperCIF;
+	      ibits	= currentCif -> data () + currentblk * BitsperBlock;
 	      for (int i = 0; i < params. get_carriers (); i ++) {
 	         int16_t      index   = myMapper. mapIn (i);
 	         if (index < 0)
@@ -154,11 +195,12 @@ std::vector<int16_t> ibits;
 	         float ab1    = jan_abs (r1);
 //	Recall:  the viterbi decoder wants 127 max pos, - 127 max neg
 //	we make the bits into softbits in the range -127 .. 127
-	         ibits [i]            =  - real (r1) / ab1 * 127.0;
+	         ibits [i]            =  softBit (- real (r1), ab1);
 	         ibits [params. get_carriers () + i]
-	                                 =  - imag (r1) / ab1 * 127.0;
+	                                 =  softBit (- imag (r1), ab1);
 	      }
-	      process_mscBlock (ibits, currentBlock);
+	      if (currentblk == numberofblocksperCIF - 1)
+	         process_CIF ();
 	   }
 
 	   memcpy (phaseReference. data (), fft_buffer,
@@ -166,6 +208,7 @@ std::vector<int16_t> ibits;
 	   freeSlots. Release ();
 	   currentBlock = (currentBlock + 1) % (params. get_L ());
 	}
+	currentCif	-> unref ();
 }
 
 //
@@ -175,58 +218,207 @@ std::vector<int16_t> ibits;
 //	the actual changing of the settings is done in the
 //	thread executing process_mscBlock
 void	mscHandler::set_audioChannel (audiodata *d) {
+	set_audioChannel (d, AUDIO_OUT_PCM);
+}
+
+void	mscHandler::set_audioChannel (audiodata *d, int16_t format) {
+	(void) add_audioChannel (d, soundOut, dataOut,
+	                         programQuality, motdata_Handler,
+	                         format, userData);
+}
+
+void	mscHandler::set_dataChannel (packetdata *d) {
+	(void) add_dataChannel (d, bytesOut, motdata_Handler, userData);
+}
+
+mscChannel	*mscHandler::add_audioChannel (audiodata	*d,
+	                                       audioOut_t	soundOut,
+	                                       dataOut_t	dataOut,
+	                                       programQuality_t	quality,
+	                                       motdata_t	motdata,
+	                                       int16_t		format,
+	                                       void		*ctx) {
+mscChannel	*c	= new mscChannel;
+
+	c	-> backend	= nullptr;
+	c	-> isAudio	= true;
+	c	-> stream	= -1;
+	c	-> soundOut	= soundOut;
+	c	-> dataOut	= dataOut;
+	c	-> quality	= quality;
+	c	-> motdata	= motdata;
+	c	-> audioFormat	= format;
+	c	-> ctx		= ctx;
 	mutexer. lock ();
-//
-//	we could assert here that theBackend == nullptr
-	theBackends. push_back (new audioBackend (d,
-	                                    soundOut,
-	                                    dataOut,
-	                                    programQuality,
-	                                    motdata_Handler,
-	                                    userData));
+	for (auto const &x : theChannels)
+	   if (x -> isAudio && (x -> audioFormat == format) &&
+	       x -> backend -> sameSubchannel (d -> startAddr, d -> length,
+	                                       d -> shortForm, d -> protLevel,
+	                                       d -> bitRate) &&
+	       (x -> soundOut == soundOut) && (x -> dataOut == dataOut) &&
+	       (x -> quality == quality) && (x -> motdata == motdata) &&
+	       (x -> ctx == ctx)) {
+	      c -> backend = x -> backend;
+	      break;
+	   }
+	if (c -> backend == nullptr) {
+	   c -> backend	= new audioBackend (d, soundOut, dataOut,
+	                                    quality, motdata, &theMotSink,
+	                                    format, thePool, ctx);
+	   c -> backend -> primeHistory (cifHistory);
+	   theBackends. push_back (c -> backend);
+	}
+	theChannels. push_back (c);
 	work_to_do. store (true);
 	mutexer. unlock ();
+	return c;
 }
 
+mscChannel	*mscHandler::add_dataChannel (packetdata	*d,
+	                                      bytesOut_t	bytesOut,
+	                                      motdata_t		motdata,
+	                                      void		*ctx) {
+mscChannel	*c	= new mscChannel;
+dataBackend	*b	= nullptr;
 
-void	mscHandler::set_dataChannel (packetdata *d) {
+	c	-> isAudio	= false;
+	c	-> soundOut	= nullptr;
+	c	-> dataOut	= nullptr;
+	c	-> quality	= nullptr;
+	c	-> audioFormat	= AUDIO_OUT_PCM;
+	c	-> motdata	= motdata;
+	c	-> ctx		= ctx;
 	mutexer. lock ();
-	theBackends. push_back (new dataBackend (d,
-	                                   bytesOut,
-	                                   motdata_Handler,
-	                                   userData));
+	for (auto const &x : theChannels)
+	   if (!x -> isAudio &&
+	       x -> backend -> sameSubchannel (d -> startAddr, d -> length,
+	                                       d -> shortForm, d -> protLevel,
+	                                       d -> bitRate)) {
+	      b	= static_cast<dataBackend *>(x -> backend);
+	      break;
+	   }
+	if (b == nullptr) {
+	   b	= new dataBackend (d, thePool);
+	   b	-> primeHistory (cifHistory);
+	   theBackends. push_back (b);
+	}
+	c	-> backend	= b;
+	c	-> stream	= b -> addStream (d, bytesOut, motdata,
+	                                          &theMotSink, &theIPSink, ctx);
+	theChannels. push_back (c);
 	work_to_do. store (true);
 	mutexer. unlock ();
+	return c;
 }
 
-void	mscHandler::process_mscBlock	(std::vector<int16_t> fbits,
-	                                 int16_t blkno) { 
-int16_t	currentblk;
-
-//	we accept the incoming data
-	currentblk	= (blkno - 4) % numberofblocksperCIF;
-	memcpy (&cifVector [currentblk * BitsperBlock],
-	                    fbits. data (), BitsperBlock * sizeof (int16_t));
-	if (currentblk < numberofblocksperCIF - 1) 
-	   return;
+bool	mscHandler::isUsed	(virtualBackend *b) {
+	for (auto const &x : theChannels)
+	   if (x -> backend == b)
+	      return true;
+	return false;
+}
+//
+//	When the last channel of a backend is removed, the backend
+//	is removed from the list - so it does not get new data - and,
+//	once idle, deleted
+void	mscHandler::remove_channel	(mscChannel *c) {
+virtualBackend	*b	= nullptr;
 
-	if (!work_to_do. load ())
-	   return;
-//	OK, now we have a full CIF
 	mutexer. lock ();
-	blkCount	= 0;
-	cifCount	= (cifCount + 1) & 03;
-	for (auto const& b: theBackends) {
-	   int startAddr	= b -> startAddr ();
-	   int Length		= b -> Length    ();
-
-	   if (Length > 0) {
-	      int16_t myBegin [Length * CUSize];
-	      memcpy (myBegin, &cifVector [startAddr * CUSize],
-	                               Length * CUSize * sizeof (int16_t));
-	      (void) b -> process (myBegin, Length * CUSize);
+	for (uint16_t i = 0; i < theChannels. size (); i ++) {
+	   if (theChannels [i] != c)
+	      continue;
+	   theChannels. erase (theChannels. begin () + i);
+	   if (!c -> isAudio)
+	      (void) static_cast<dataBackend *>(c -> backend) ->
+	                                       removeStream (c -> stream);
+	   if (!isUsed (c -> backend)) {
+	      b	= c -> backend;
+	      for (uint16_t j = 0; j < theBackends. size (); j ++)
+	         if (theBackends [j] == b) {
+	            theBackends. erase (theBackends. begin () + j);
+	            break;
+	         }
 	   }
+	   delete c;
+	   break;
 	}
 	mutexer. unlock ();
+	if (b != nullptr) {
+	   b -> stopRunning ();
+	   delete b;
+	}
+	theMotSink. flush ();
+}
+
+void	mscHandler::getChannelStats	(mscChannel *c,
+	                                 int32_t &frames, int32_t &errors) {
+	frames	= 0;
+	errors	= 0;
+	mutexer. lock ();
+	if ((c != nullptr) && !c -> isAudio)
+	   static_cast<dataBackend *>(c -> backend) ->
+	                        getStreamStats (c -> stream, frames, errors);
+	mutexer. unlock ();
+}
+
+//
+//	The backends are handled by the workers of a pool, shared by
+//	all msc handlers in the process, the number of workers can be
+//	set here. 0 means that the library chooses, depending on the
+//	number of cores
+void	mscHandler::set_backendThreads	(int16_t n) {
+	thePool	-> setThreads (n);
+}
+
+void	mscHandler::setMotObjectHandler	(motObject_t h, bool writeFiles) {
+	theMotSink. setObjectHandler (h, userData, writeFiles);
 }
 
+int32_t	mscHandler::getProgrammes	(uint32_t SId,
+	                                 int64_t from, int64_t to,
+	                                 epgProgramme_t handler, void *ctx) {
+	return theEPG. getProgrammes (SId, from, to, handler, ctx);
+}
+
+bool	mscHandler::exportEPG		(const std::string &fileName) {
+	return theEPG. exportXml (fileName);
+}
+
+bool	mscHandler::setIPSink		(const std::string &address, int port) {
+	return theIPSink. setDestination (address, port);
+}
+
+void	mscHandler::setIPTunnel		(int fd) {
+	theIPSink. setTunnel (fd);
+}
+
+//
+//	A CIF is complete, each backend gets a reference to it and
+//	the offset and length of its subchannel - no copying.
+//	The CIF is kept in the history, and the handler itself
+//	continues with a fresh buffer
+void	mscHandler::process_CIF	(void) {
+	mutexer. lock ();
+	if (cifHistory. size () >= 16) {
+	   cifHistory. front () -> unref ();
+	   cifHistory. erase (cifHistory. begin ());
+	}
+	currentCif	-> ref ();
+	cifHistory. push_back (currentCif);
+	if (work_to_do. load ()) {
+	   blkCount	= 0;
+	   cifCount	= (cifCount + 1) & 03;
+	   for (auto const& b: theBackends) {
+	      int startAddr	= b -> startAddr ();
+	      int Length	= b -> Length    ();
+
+	      if (Length > 0)
+	         (void) b -> process (currentCif,
+	                              startAddr * CUSize, Length * CUSize);
+	   }
+	}
+	mutexer. unlock ();
+	currentCif	-> unref ();
+	currentCif	= cifs. get ();
+}
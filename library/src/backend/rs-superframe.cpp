@@ -0,0 +1,105 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include	"rs-superframe.h"
+#include	<string.h>
+//
+//	The code is the one from ETSI TS 102 563, i.e. the shortened
+//	RS (255, 245) code, field polynomial x^8 + x^4 + x^3 + x^2 + 1
+//	(0435), first root alpha^0.
+//	The shortening zeros do not contribute to the syndromes,
+//	so Horner can be applied to the 120 transmitted bytes only
+	rsSuperframe::rsSuperframe (int16_t RSDims):
+	                                genericDecoder (8, 0435, 0, 1, 10) {
+uint8_t	alpha_to [255];
+uint8_t	index_of [256];
+uint16_t sr	= 1;
+
+	this	-> RSDims	= RSDims;
+	syndromes. resize (10 * RSDims);
+
+	for (int i = 0; i < 255; i ++) {
+	   alpha_to [i]	= sr;
+	   index_of [sr]	= i;
+	   sr <<= 1;
+	   if (sr & 0400)
+	      sr ^= 0435;
+	}
+
+	for (int i = 0; i < 10; i ++) {
+	   mulTable [i][0] = 0;
+	   for (int x = 1; x < 256; x ++)
+	      mulTable [i][x] = alpha_to [(index_of [x] + i) % 255];
+	}
+}
+
+	rsSuperframe::~rsSuperframe (void) {
+}
+
+int16_t	rsSuperframe::decode (const uint8_t *frame,
+	                      int16_t base, uint8_t *out) {
+const int32_t	frameSize	= RSDims * 120;
+uint8_t	*S		= syndromes. data ();
+int16_t	corrections	= 0;
+
+	memset (S, 0, 10 * RSDims);
+//
+//	row k of the superframe holds byte k of each of the codewords,
+//	all syndromes are updated for the row at once
+	for (int k = 0; k < 120; k ++) {
+	   int32_t index	= base + k * RSDims;
+	   for (int j = 0; j < RSDims; j ++, index ++) {
+	      if (index >= frameSize)
+	         index -= frameSize;
+	      uint8_t	v	= frame [index];
+	      if (k < 110)
+	         out [j + k * RSDims] = v;
+	      S [j]		^= v;		// alpha^0 == 1
+	      for (int i = 1; i < 10; i ++)
+	         S [i * RSDims + j] =
+	                    mulTable [i][S [i * RSDims + j]] ^ v;
+	   }
+	}
+//
+//	the common case: all codewords are clean
+	for (int j = 0; j < RSDims; j ++) {
+	   uint8_t	dirty	= 0;
+	   for (int i = 0; i < 10; i ++)
+	      dirty |= S [i * RSDims + j];
+	   if (dirty == 0)
+	      continue;
+
+	   uint8_t	rsIn	[120];
+	   uint8_t	rsOut	[110];
+	   for (int k = 0; k < 120; k ++)
+	      rsIn [k] = frame [(base + j + k * RSDims) % frameSize];
+	   int16_t ler	= genericDecoder. dec (rsIn, rsOut, 135);
+	   if (ler < 0)
+	      return -1;
+	   for (int k = 0; k < 110; k ++)
+	      out [j + k * RSDims] = rsOut [k];
+	   corrections += ler;
+	}
+	return corrections;
+}
+
@@ -0,0 +1,119 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include	"time-deinterleaver.h"
+#include	<string.h>
+//
+//	soft bit i of the output for CIF n is taken from CIF
+//	n - 16 + interleaveMap [i % 16]
+static
+const	int16_t interleaveMap [] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
+
+	timeDeinterleaver::timeDeinterleaver (int16_t fragmentSize):
+	                                       freeSlots (QUEUE_SIZE) {
+	this	-> fragmentSize		= fragmentSize;
+	this	-> nrRows		= 16 + QUEUE_SIZE;
+	ring. resize (nrRows);
+	for (int i = 0; i < nrRows; i ++)
+	   ring [i]. cif = nullptr;
+	nextIn			= 0;
+	nextOut			= 0;
+	countforInterleaver	= 0;
+}
+
+	timeDeinterleaver::~timeDeinterleaver (void) {
+	for (int i = 0; i < nrRows; i ++)
+	   if (ring [i]. cif != nullptr)
+	      ring [i]. cif -> unref ();
+}
+//
+//	The producer may run at most QUEUE_SIZE fragments ahead of the
+//	consumer, so it never overwrites one of the 16 rows of history
+//	still needed. Each fragment consumed frees one row
+bool	timeDeinterleaver::add	(cifBuffer *cif, int32_t offset,
+	                         std::atomic<bool> &running) {
+	while (!freeSlots. tryAcquire (200))
+	   if (!running. load ())
+	      return false;
+	if (ring [nextIn]. cif != nullptr)	// should not happen
+	   ring [nextIn]. cif -> unref ();
+	cif	-> ref ();
+	ring [nextIn]. cif	= cif;
+	ring [nextIn]. offset	= offset;
+	nextIn	= (nextIn + 1) % nrRows;
+	usedSlots. Release ();
+	return true;
+}
+//
+//	Priming with n CIFs gives the state the deinterleaver would
+//	have after adding and fetching these n fragments
+void	timeDeinterleaver::prime	(std::vector<cifBuffer *> &history,
+	                                 int32_t offset) {
+int16_t	n	= history. size () > 16 ? 16 : history. size ();
+
+	for (int16_t i = 0; i < n; i ++) {
+	   cifBuffer *cif	= history [history. size () - n + i];
+	   cif	-> ref ();
+	   ring [i]. cif	= cif;
+	   ring [i]. offset	= offset;
+	}
+	nextIn			= n;
+	nextOut			= n;
+	countforInterleaver	= n;
+}
+//
+//	For each of the 16 phases (i % 16) the soft bits come from a
+//	single row, so the output is built with 16 stride-16 passes,
+//	each over a different row, rather than looking up the row
+//	for each individual soft bit.
+bool	timeDeinterleaver::fetch (int8_t *out) {
+	if (!usedSlots. tryAcquire (0))
+	   return false;
+
+	int16_t current	= nextOut;
+	nextOut	= (nextOut + 1) % nrRows;
+//	only continue when de-interleaver is filled
+	if (countforInterleaver <= 15) {
+	   countforInterleaver ++;
+	   freeSlots. Release ();
+	   return false;
+	}
+
+	for (int phase = 0; phase < 16; phase ++) {
+	   int16_t row	= (current + nrRows - 16 +
+	                               interleaveMap [phase]) % nrRows;
+	   const int8_t *src	= ring [row]. cif -> data () +
+	                                          ring [row]. offset;
+	   for (int i = phase; i < fragmentSize; i += 16)
+	      out [i] = src [i];
+	}
+//
+//	the oldest row of the history is not needed anymore,
+//	its CIF is released and the row can be reused by the producer
+	int16_t oldest	= (current + nrRows - 16) % nrRows;
+	ring [oldest]. cif -> unref ();
+	ring [oldest]. cif	= nullptr;
+	freeSlots. Release ();
+	return true;
+}
+
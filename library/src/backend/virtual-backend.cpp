@@ -24,17 +24,20 @@
 //
 #include	"dab-constants.h"
 #include	"virtual-backend.h"
+#include	"backend-pool.h"
 
         virtualBackend::virtualBackend  (int16_t a, int16_t l) {
         startAddress    = a;
         segmentLength   = l;
+	pendingCount. store (0);
 }
 
         virtualBackend::~virtualBackend (void) {
 }
 
-int32_t virtualBackend::process (int16_t *v, int16_t c) {
+int32_t virtualBackend::process (cifBuffer *v, int32_t o, int16_t c) {
         (void)v;
+        (void)o;
         (void)c;
         return 32768;
 }
@@ -54,4 +57,42 @@ void    virtualBackend::stopRunning     (void) {
 void    virtualBackend::stop    (void) {
 }
 
+void	virtualBackend::processPending	(void) {
+}
+
+void	virtualBackend::primeHistory	(std::vector<cifBuffer *> &h) {
+	(void)h;
+}
+
+bool	virtualBackend::sameSubchannel	(int16_t startAddr, int16_t length,
+	                                 bool shortForm, int16_t protLevel,
+	                                 int16_t bitRate) {
+	(void)startAddr;
+	(void)length;
+	(void)shortForm;
+	(void)protLevel;
+	(void)bitRate;
+	return false;
+}
+
+void	virtualBackend::fragmentAdded	(backendPool *pool) {
+	if (pendingCount. fetch_add (1) == 0)
+	   pool -> schedule (this);
+}
+//
+//	Once the count is 0 the backend may be deleted, so after
+//	the decrement only the pool is touched
+bool	virtualBackend::fragmentDone	(backendPool *pool) {
+	if (pendingCount. fetch_sub (1) > 1)
+	   return true;
+	pool -> backendIdle ();
+	return false;
+}
+//
+//	after a stop, the backend may still be in the readyList
+//	of the pool, or being handled by a worker
+void	virtualBackend::waitforIdle	(backendPool *pool) {
+	pool -> waitIdle (&pendingCount);
+}
+
 
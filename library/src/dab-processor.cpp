@@ -20,6 +20,7 @@
  *    along with DAB-library; if not, write to the Free Software
  *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
+#include	<unistd.h>
 #include	"dab-processor.h"
 #include	"device-handler.h"
 #include	"timesyncer.h"
@@ -47,14 +48,6 @@
 	                                 RingBuffer<std::complex<float>> *spectrumBuffer,
 	                                 RingBuffer<std::complex<float>> *iqBuffer,
 	                                 void		*userData):
-	                                    tii_framedelay  (20),
-                                            tii_counter     (0),
-#ifdef	__TII_INCLUDED__
-                                            my_tiiHandler   (nullptr),
-                                            my_tiiExHandler (nullptr),
-#endif
-                                            tii_alfa        (-1.0F),
-                                            tii_resetFrameCount (-1),
 	                                    params (dabMode),
 	                                    myReader (this,
 	                                              inputDevice,
@@ -64,7 +57,7 @@
 	                                    my_ofdmDecoder (dabMode,
 	                                                    iqBuffer),
 #ifdef	__TII_INCLUDED__
-	                                    my_TII_Detector (dabMode),
+	                                    my_tiiProcessor (dabMode, userData),
 #endif
 	                                    my_ficHandler (dabMode,
 	                                                   ensemblename_Handler,
@@ -77,7 +70,9 @@
                                                             bytesOut,
                                                             mscQuality,
                                                             motdata_Handler,
-                                                            userData) {
+                                                            userData),
+	                                    fullEnsemble (&my_mscHandler,
+	                                                  &my_ficHandler) {
 	this	-> inputDevice		= inputDevice;
 	this	-> syncsignalHandler	= syncsignalHandler;
 	this	-> systemdataHandler	= systemdataHandler;
@@ -93,6 +88,13 @@
 	this	-> carrierDiff		= params. get_carrierDiff ();
 	isSynced	= false;
 	snr		= 0;
+	cacheFrequency	= -1;
+	cacheCheck	= 0;
+	savedFrequency	= -1;
+	savedVersion	= 0;
+	lastVersion	= 0;
+	cacheRemoved	= false;
+	retuneAck	= false;
 	running. store (false);
 }
 
@@ -122,6 +124,7 @@ float		fineOffset	= 0;
 float		coarseOffset	= 0;
 bool		correctionNeeded	= true;
 std::vector<complex<float>>	ofdmBuffer (T_null);
+std::vector<int16_t>		ibits (2 * params. get_carriers ());
 int		dip_attempts		= 0;
 int		index_attempts		= 0;
 float		avgValue_nullPeriod	= 0;
@@ -129,12 +132,21 @@ float		avgValue_testPeriod	= 0;
 int		testLength		= 100;
 int		startIndex		= -1;
 
-	isSynced	= false;
-	snr		= 0;
 	running. store (true);
-	my_ficHandler. reset ();
 	myReader. setRunning (true);
 	my_mscHandler. start ();
+	my_ficHandler. reset ();
+//
+//	after a retune we start all over again, without leaving the thread
+//	(the ensemble is already cleared by retuneReset)
+Restart:
+	isSynced		= false;
+	snr			= 0;
+	fineOffset		= 0;
+	coarseOffset		= 0;
+	correctionNeeded	= true;
+	dip_attempts		= 0;
+	index_attempts		= 0;
 
 	try {
 	   myReader. reset ();
@@ -145,7 +157,7 @@ int		startIndex		= -1;
 notSynced:
 //Initing:
 #ifdef	__TII_INCLUDED__
-	   my_TII_Detector. reset ();
+	   my_tiiProcessor. reset ();
 #endif
            switch (myTimeSyncer. sync (T_null, T_F)) {
               case TIMESYNC_ESTABLISHED:
@@ -243,7 +255,6 @@ SyncOnPhase:
 //	corresponding samples in the datapart.
 ///	and similar for the (params. L - 4) MSC blocks
 	   FreqCorr		= std::complex<float> (0, 0);
-	   std::vector<int16_t> ibits (2 * params. get_carriers ());
 	   for (int ofdmSymbolCount = 1;
 	        ofdmSymbolCount < (uint16_t)nrBlocks; ofdmSymbolCount ++) {	
 	      myReader. getSamples (ofdmBuffer. data (),
@@ -257,7 +268,21 @@ SyncOnPhase:
 	      if (ofdmSymbolCount < 4) {
 	         my_ofdmDecoder. decode (ofdmBuffer. data (),
 	                                 ofdmSymbolCount, ibits. data ());
-	         my_ficHandler. process_ficBlock (ibits, ofdmSymbolCount);
+	         my_ficHandler. process_ficBlock (ibits. data (),
+	                                          ofdmSymbolCount);
+	      }
+//
+//	in "decode all" mode, the set of services follows the changes
+//	in the ensemble (a reconfiguration), the backends are added
+//	and removed by the control thread of the fullEnsembleHandler
+	      if (ofdmSymbolCount == 3)
+	         fullEnsemble. ensembleChanged (
+	                            my_ficHandler. get_changeCount ());
+//
+//	and every 50 frames or so whether the ensemble is to be cached
+	      if ((ofdmSymbolCount == 3) && (-- cacheCheck <= 0)) {
+	         checkCache ();
+	         cacheCheck	= 50;
 	      }
 	      my_mscHandler. process_mscBlock (&((ofdmBuffer. data ()) [T_g]),
 	                                                   ofdmSymbolCount);
@@ -287,58 +312,11 @@ SyncOnPhase:
 #ifdef	__TII_INCLUDED__
 /*
  *      The TII data is encoded in the null period of the
- *      odd frames
+ *      odd frames, it is handed over to the tii thread
  */
-           if (params. get_dabMode () == 1) {
-              if ((my_tiiHandler || my_tiiExHandler)) {
-                 int32_t cifCounter = my_ficHandler. get_CIFcount ();
-                 if (wasSecond (cifCounter, &params)) {
-                    my_TII_Detector.
-                          addBuffer (ofdmBuffer,
-                                     tii_alfa, cifCounter);
-                    tii_counter ++;
-                    if (tii_counter >= tii_framedelay) {
-                       if (my_tiiHandler) {
-                          int16_t mainId        = -1;
-                          int16_t subId         = -1;
-                          my_TII_Detector. processNULL (&mainId, &subId);
-                          my_tiiHandler (mainId, subId,
-                                         my_TII_Detector. getNumBuffers(),
-	                                 userData);
-	                } else {
-                          int numOut = 0;
-                          int outTii [24];
-                          float outAvgSNR [24];
-                          float outMinSNR [24];
-                          float outNxtSNR [24];
-                          my_TII_Detector. processNULL_ex (&numOut,
-                                                           outTii,
-                                                           outAvgSNR,
-                                                           outMinSNR,
-                                                           outNxtSNR);
-	                  if (numOut > 0)
-                             my_tiiExHandler (numOut,
-                                              outTii,
-                                              outAvgSNR,
-                                              outMinSNR,
-                                              outNxtSNR,
-                                              my_TII_Detector.getNumBuffers(),
-                                              my_TII_Detector.P_allAvg,
-                                              (int)T_u,
-                                              userData);
-                       }
-                    }
-                    if (tii_counter >= tii_framedelay)
-                       tii_counter = 0;
-                    if (my_TII_Detector. getNumBuffers() >=
-                         tii_resetFrameCount &&
-                        (tii_resetFrameCount > 0)) {
-                       my_TII_Detector. reset ();
-                    }
-                 }
-              }
-
-	   }
+	   if ((params. get_dabMode () == 1) && my_tiiProcessor. isActive () &&
+	       wasSecond (my_ficHandler. get_CIFcount (), &params))
+	      my_tiiProcessor. addBuffer (ofdmBuffer. data ());
 #endif
 	   if (fineOffset > carrierDiff / 2) {
 	      coarseOffset += carrierDiff;
@@ -353,8 +331,12 @@ SyncOnPhase:
 	}
 	
 	catch (int e) {
-	   ;
+	   if ((e == 22) && running. load ()) {
+	      retuneReset ();
+	      goto Restart;
+	   }
 	}
+	fullEnsemble. clear ();
 	my_mscHandler.  stop ();
 //	fprintf (stderr, "dabProcessor is shutting down\n");
 }
@@ -364,14 +346,59 @@ void	dabProcessor:: reset	(void) {
 	start ();
 }
 
+//
+//	No need to wait here: with running false, the reader throws and
+//	the thread terminates, the join is the signal that it did
 void	dabProcessor::stop	(void) {	
 	if (running. load ()) {
 	   running. store (false);
 	   myReader. setRunning (false);
-	   sleep (1);
 	   threadHandle. join ();
 	}
 }
+//
+//	retune is to be called after the device is set to another
+//	frequency. The processor thread flushes the input, removes the
+//	services and restarts synchronization and FIC handling, it
+//	signals completion through retuneDone. The thread, the msc
+//	thread, the fft plans and the buffers remain as they are
+//	The library is not told the new frequency, so nothing is cached
+//	until the next preloadEnsemble
+bool	dabProcessor::retune	(void) {
+std::unique_lock<std::mutex> lck (retuneLocker);
+
+	if (!running. load ())
+	   return false;
+	cacheFrequency	= -1;
+	my_ficHandler. preload (nullptr);
+	retuneAck	= false;
+	myReader. setRetune (true);
+	if (retuneDone. wait_for (lck, std::chrono::seconds (2),
+	                          [this] { return retuneAck; }))
+	   return true;
+//	failure reported, so no restart later on
+	myReader. setRetune (false);
+	return false;
+}
+//
+//	executed by the processor thread, after the reader threw.
+//	The old ensemble is gone before the caller of retune is released,
+//	so queries after the retune never see the previous multiplex
+void	dabProcessor::retuneReset	(void) {
+	inputDevice	-> resetBuffer ();
+	myReader. reset ();
+	fullEnsemble. reset ();
+	my_mscHandler. clearHistory ();
+	my_ficHandler. reset ();
+#ifdef	__TII_INCLUDED__
+	my_tiiProcessor. reset ();
+#endif
+
+	std::unique_lock<std::mutex> lck (retuneLocker);
+	myReader. setRetune (false);
+	retuneAck	= true;
+	retuneDone. notify_all ();
+}
 
 void	dabProcessor::call_systemData (bool f, int16_t snr, int32_t freq) {
 	if (systemdataHandler != nullptr)
@@ -416,20 +443,144 @@ std::string dabProcessor::get_serviceName (int32_t SId) {
 	return my_ficHandler. nameFor (SId);
 }
 
+uint32_t dabProcessor::get_ensembleChanges (void) {
+	return my_ficHandler. get_changeCount ();
+}
+
+int	dabProcessor::getEnsemble (ensembleComponent_t h, void *ctx) {
+	return my_ficHandler. enumerate (h, ctx);
+}
+
 void    dabProcessor::reset_msc (void) {
-        my_mscHandler. reset ();
+	fullEnsemble. reset ();
+}
+
+void	dabProcessor::set_backendThreads	(int16_t n) {
+	my_mscHandler. set_backendThreads (n);
+}
+
+void	dabProcessor::startDecodeAll	(serviceCallbacks *cb, void *ctx) {
+	fullEnsemble. start (cb, ctx);
+}
+
+void	dabProcessor::stopDecodeAll	(void) {
+	fullEnsemble. stop ();
+}
+
+int	dabProcessor::getServiceStats	(serviceStats *s, int max) {
+	return fullEnsemble. getStats (s, max);
+}
+
+void	dabProcessor::setMotObjectHandler (motObject_t h, bool writeFiles) {
+	my_mscHandler. setMotObjectHandler (h, writeFiles);
+}
+
+int32_t	dabProcessor::getProgrammes	(uint32_t SId,
+	                                 int64_t from, int64_t to,
+	                                 epgProgramme_t h, void *ctx) {
+	return my_mscHandler. getProgrammes (SId, from, to, h, ctx);
+}
+
+bool	dabProcessor::exportEPG	(const std::string &fileName) {
+	return my_mscHandler. exportEPG (fileName);
+}
+
+bool	dabProcessor::setIPSink	(const std::string &address, int port) {
+	return my_mscHandler. setIPSink (address, port);
+}
+
+void	dabProcessor::setIPTunnel	(int fd) {
+	my_mscHandler. setIPTunnel (fd);
+}
+//
+//	The warm start cache: one file per frequency in the directory
+bool	dabProcessor::setEnsembleCache	(const std::string &directory) {
+std::lock_guard<std::mutex> lck (cacheLocker);
+
+	if ((directory != "") && (access (directory. c_str (), W_OK) != 0)) {
+	   cacheDirectory	= "";
+	   return false;
+	}
+	cacheDirectory	= directory;
+	return true;
+}
+
+std::string	dabProcessor::cacheName	(int32_t frequency) {
+std::lock_guard<std::mutex> lck (cacheLocker);
+
+	if (cacheDirectory == "")
+	   return "";
+	return cacheDirectory + "/ensemble-" +
+	                       std::to_string (frequency) + ".cache";
+}
+//
+//	The database from the cache is installed at once, the FIC
+//	confirms (or corrects) it later on. From now on the ensemble
+//	is cached under this frequency
+bool	dabProcessor::preloadEnsemble	(int32_t frequency) {
+std::string	name	= cacheName (frequency);
+ensembleDB	*cached;
+
+	cacheFrequency	= frequency;
+	if (name == "")
+	   return false;
+	cached	= new ensembleDB ();
+	if (!cached -> load (name, frequency)) {
+	   delete cached;
+	   my_ficHandler. preload (nullptr);
+	   return false;
+	}
+	my_ficHandler. preload (std::shared_ptr<const ensembleDB> (cached));
+	return true;
+}
+//
+//	executed by the processor thread: the ensemble is saved once
+//	it did not change for a while, and the file is removed when the
+//	FIC announces a reconfiguration. The announcement is repeated,
+//	the file is removed once, until the next save.
+//	The file handling itself is done by the cacheWriter
+void	dabProcessor::checkCache	(void) {
+int32_t		frequency	= cacheFrequency. load ();
+uint32_t	version		= my_ficHandler. get_changeCount ();
+std::string	name;
+std::shared_ptr<const ensembleDB> s;
+
+	if (frequency < 0)
+	   return;
+	name	= cacheName (frequency);
+	if (name == "")
+	   return;
+	if (frequency != savedFrequency) {
+	   savedFrequency	= frequency;
+	   savedVersion		= version;	// i.e. the preloaded one
+	   lastVersion		= version;
+	   cacheRemoved		= false;
+	   return;
+	}
+	if (my_ficHandler. cacheIsStale ()) {
+	   if (!cacheRemoved)
+	      theCacheWriter. remove (name);
+	   cacheRemoved	= true;
+	   lastVersion	= version;
+	   return;
+	}
+	if ((version == lastVersion) && (version != savedVersion)) {
+	   s	= my_ficHandler. ensembleToSave ();
+	   if (s != nullptr) {
+	      theCacheWriter. save (name, frequency, s);
+	      savedVersion	= version;
+	      cacheRemoved	= false;
+	   }
+	}
+	lastVersion	= version;
 }
 #ifdef	__TII_INCLUDED__
 void    dabProcessor::setTII_handler (tii_t tii_Handler,
 	                              tii_ex_t tii_ExHandler,
 	                              int framedelay,
 	                              float alfa, int resetFrameCount) {
-	if (framedelay > 0)
-	   tii_framedelay = framedelay;
-	my_tiiHandler		= tii_Handler;
-	my_tiiExHandler		= tii_ExHandler;
-	tii_alfa		= alfa;
-	tii_resetFrameCount	= resetFrameCount;
+	my_tiiProcessor. setHandlers (tii_Handler, tii_ExHandler,
+	                              framedelay, alfa, resetFrameCount);
 }
 
 std::complex<float>
@@ -458,7 +609,11 @@ uint8_t dabProcessor::getInterTabId     (bool *success) {
 #endif
 
 void    dabProcessor::set_audioChannel (audiodata *d) {
-        my_mscHandler. set_audioChannel (d);
+	set_audioChannel (d, AUDIO_OUT_PCM);
+}
+
+void    dabProcessor::set_audioChannel (audiodata *d, int16_t format) {
+        my_mscHandler. set_audioChannel (d, format);
 	programdataHandler (d, userData);
 }
 
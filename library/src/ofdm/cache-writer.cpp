@@ -0,0 +1,96 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#include	<cstdio>
+#include	"cache-writer.h"
+
+	cacheWriter::cacheWriter	(void) {
+	stopping	= false;
+	started		= false;
+}
+//
+//	jobs still queued are done before the thread stops
+	cacheWriter::~cacheWriter	(void) {
+	std::unique_lock<std::mutex> lck (locker);
+	stopping	= true;
+	lck. unlock ();
+	jobAvailable. notify_all ();
+	if (started)
+	   threadHandle. join ();
+}
+
+void	cacheWriter::save	(const std::string &name,
+	                         int32_t frequency,
+	                         std::shared_ptr<const ensembleDB> db) {
+cacheJob	job;
+
+	job. name	= name;
+	job. frequency	= frequency;
+	job. db		= db;
+	addJob (job);
+}
+
+void	cacheWriter::remove	(const std::string &name) {
+cacheJob	job;
+
+	job. name	= name;
+	job. frequency	= -1;
+	job. db		= nullptr;
+	addJob (job);
+}
+
+void	cacheWriter::addJob	(cacheJob &job) {
+	std::unique_lock<std::mutex> lck (locker);
+	if (stopping)
+	   return;
+	jobs. push_back (std::move (job));
+	if (!started) {
+	   threadHandle	= std::thread (&cacheWriter::run, this);
+	   started	= true;
+	}
+	lck. unlock ();
+	jobAvailable. notify_one ();
+}
+//
+//	the jobs are done in order, so a remove queued after a save
+//	is not undone by it
+void	cacheWriter::run	(void) {
+	std::unique_lock<std::mutex> lck (locker);
+	while (true) {
+	   while ((jobs. size () == 0) && !stopping)
+	      jobAvailable. wait (lck);
+	   if (jobs. size () == 0)	// and stopping
+	      break;
+	   cacheJob job	= std::move (jobs. front ());
+	   jobs. pop_front ();
+	   lck. unlock ();
+
+	   if (job. db == nullptr)
+	      std::remove (job. name. c_str ());
+	   else
+	      (void) job. db -> save (job. name, job. frequency);
+
+	   lck. lock ();
+	}
+}
+
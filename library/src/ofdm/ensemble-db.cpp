@@ -0,0 +1,643 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+#include	<cstring>
+#include	<cstdio>
+#include	<algorithm>
+#include	"ensemble-db.h"
+#include	"dab-constants.h"
+#include	"crc-handler.h"
+
+	ensembleDB::ensembleDB (void) {
+	clear ();
+}
+
+	ensembleDB::~ensembleDB (void) {
+}
+
+void	ensembleDB::clear	(void) {
+int16_t	i;
+
+	version		= 0;
+	EId		= -1;
+	services. clear ();
+	bySId. clear ();
+	byLabel. clear ();
+	clearComponents ();
+	for (i = 0; i < 64; i ++) {
+	   memset (&subChannels [i], 0, sizeof (channelMap));
+	   subChannels [i]. inUse	= false;
+	}
+	coordinates. cleanUp ();
+}
+
+void	ensembleDB::clearComponents	(void) {
+	components. clear ();
+	byComponent. clear ();
+	bySCId. clear ();
+}
+
+static inline
+uint64_t componentKey	(uint32_t SId, int16_t compNr) {
+	return ((uint64_t)SId << 8) | (uint8_t)compNr;
+}
+//
+//	the names in the FIC are padded with spaces to 16 characters,
+//	the label index uses them without
+static
+std::string	normalized	(const std::string &s) {
+size_t	l	= s. find_last_not_of (' ');
+
+	return l == std::string::npos ? std::string ("") : s. substr (0, l + 1);
+}
+
+serviceId	*ensembleDB::findService	(uint32_t SId) {
+auto	it	= bySId. find (SId);
+
+	return it == bySId. end () ? nullptr : &services [it -> second];
+}
+
+const serviceId	*ensembleDB::findService	(uint32_t SId) const {
+auto	it	= bySId. find (SId);
+
+	return it == bySId. end () ? nullptr : &services [it -> second];
+}
+
+serviceId	*ensembleDB::addService	(uint32_t SId) {
+serviceId	*s	= findService (SId);
+serviceId	n;
+
+	if (s != nullptr)
+	   return s;
+	if (services. size () >= MAX_SERVICES)
+	   return nullptr;
+
+	n. serviceId		= SId;
+	n. confirmed		= true;
+	n. serviceLabel. hasName	= false;
+	n. serviceLabel. fromCache	= false;
+	n. hasPNum		= false;
+	n. hasLanguage		= false;
+	n. language		= -1;
+	n. programType		= 0;
+	n. pNum			= 0;
+	bySId [SId]	= services. size ();
+	services. push_back (n);
+	return &services. back ();
+}
+//
+//	with duplicate labels, the first one wins. A label may change
+//	when a cached one is replaced by the one from the FIC
+void	ensembleDB::setLabel	(serviceId *s, const std::string &label) {
+int32_t	index	= s - services. data ();
+
+	if (s -> serviceLabel. hasName) {
+	   auto it = byLabel. find (normalized (s -> serviceLabel. label));
+	   if ((it != byLabel. end ()) && (it -> second == index))
+	      byLabel. erase (it);
+	}
+	s -> serviceLabel. label	= label;
+	s -> serviceLabel. hasName	= true;
+	s -> serviceLabel. fromCache	= false;
+	byLabel. insert (std::make_pair (normalized (label), index));
+}
+//
+//	since some servicenames are long, we allow selection of a
+//	service based on the first few letters/digits of the name.
+//	However, in case of servicenames where one is a prefix
+//	of the other, the full match should have precedence over the
+//	prefix match. As before, a name followed by a space in the
+//	label counts as a full match, so "Radio 1" selects "Radio 1 Extra"
+//	if there is no "Radio 1"
+const serviceId	*ensembleDB::findService (const std::string &name) const {
+std::string	key	= normalized (name);
+int32_t		prefixMatch	= -1;
+
+	auto it = byLabel. lower_bound (key);
+	if ((it != byLabel. end ()) && (it -> first == key))
+	   return &services [it -> second];
+
+	for (; it != byLabel. end (); it ++) {
+	   if (it -> first. compare (0, key. size (), key) != 0)
+	      break;
+	   if (it -> first [key. size ()] == ' ')
+	      return &services [it -> second];
+	   if (prefixMatch < 0)
+	      prefixMatch = it -> second;
+	}
+	return prefixMatch >= 0 ? &services [prefixMatch] : nullptr;
+}
+
+serviceComponent *ensembleDB::findComponent (uint32_t SId, int16_t compNr) {
+auto	it	= byComponent. find (componentKey (SId, compNr));
+
+	return it == byComponent. end () ? nullptr : &components [it -> second];
+}
+
+const serviceComponent *ensembleDB::findComponent (uint32_t SId,
+	                                           int16_t compNr) const {
+auto	it	= byComponent. find (componentKey (SId, compNr));
+
+	return it == byComponent. end () ? nullptr : &components [it -> second];
+}
+
+serviceComponent *ensembleDB::findPacketComponent (uint16_t SCId) {
+auto	it	= bySCId. find (SCId);
+
+	return it == bySCId. end () ? nullptr : &components [it -> second];
+}
+
+serviceComponent *ensembleDB::addComponent (const serviceComponent &c) {
+int32_t	index	= components. size ();
+
+	if (components. size () >= MAX_COMPONENTS)
+	   return nullptr;
+	components. push_back (c);
+	byComponent. insert (std::make_pair (componentKey (c. SId,
+	                                                  c. componentNr),
+	                                     index));
+	if (c. TMid == 03)
+	   bySCId. insert (std::make_pair (c. SCId, index));
+	return &components. back ();
+}
+
+void	ensembleDB::reindex	(void) {
+int32_t	i;
+
+	bySId. clear ();
+	byLabel. clear ();
+	byComponent. clear ();
+	bySCId. clear ();
+	for (i = 0; i < (int32_t)services. size (); i ++) {
+	   bySId [services [i]. serviceId] = i;
+	   if (services [i]. serviceLabel. hasName)
+	      byLabel. insert (std::make_pair (
+	                     normalized (services [i]. serviceLabel. label), i));
+	}
+	for (i = 0; i < (int32_t)components. size (); i ++) {
+	   byComponent. insert (std::make_pair (
+	                     componentKey (components [i]. SId,
+	                                   components [i]. componentNr), i));
+	   if (components [i]. TMid == 03)
+	      bySCId. insert (std::make_pair (components [i]. SCId, i));
+	}
+}
+
+bool	ensembleDB::hasUnconfirmed	(void) const {
+int16_t	i;
+
+	for (auto &s : services)
+	   if (!s. confirmed)
+	      return true;
+	for (auto &c : components)
+	   if (!c. confirmed)
+	      return true;
+	for (i = 0; i < 64; i ++)
+	   if (subChannels [i]. inUse && !subChannels [i]. confirmed)
+	      return true;
+	return false;
+}
+//
+//	prune removes what was loaded from the cache, but not seen in
+//	the FIC during the confirmation period
+void	ensembleDB::prune	(void) {
+std::vector<serviceId>		s;
+std::vector<serviceComponent>	c;
+int16_t	i;
+
+	for (auto &service : services)
+	   if (service. confirmed)
+	      s. push_back (service);
+	for (auto &comp : components)
+	   if (comp. confirmed)
+	      c. push_back (comp);
+	for (i = 0; i < 64; i ++)
+	   if (!subChannels [i]. confirmed)
+	      subChannels [i]. inUse = false;
+	services. swap (s);
+	components. swap (c);
+	reindex ();
+}
+//
+//	The cache file is a compact, big endian, byte stream:
+//	   magic "DABE", a format version byte, the frequency (4 bytes)
+//	   and the EId (2 bytes),
+//	   the number of subchannels in use, followed by their descriptions,
+//	   the number of services, followed by their descriptions,
+//	   the number of components, followed by their descriptions,
+//	   an (inverted) CRC16 over all preceding bytes, as used in the FIC.
+#define	CACHE_FORMAT	1
+
+static inline
+void	put	(std::vector<uint8_t> &b, uint32_t v, int16_t nBytes) {
+	while (-- nBytes >= 0)
+	   b. push_back ((v >> (8 * nBytes)) & 0xFF);
+}
+
+static inline
+uint32_t get	(const std::vector<uint8_t> &b, uint32_t &p, int16_t nBytes) {
+uint32_t	v	= 0;
+
+	while (-- nBytes >= 0)
+	   v = (v << 8) | b [p ++];
+	return v;
+}
+
+bool	ensembleDB::save	(const std::string &fileName,
+	                         int32_t frequency) const {
+std::vector<uint8_t> b;
+std::string	tempName	= fileName + ".tmp";
+uint16_t	crc;
+int16_t	i, n	= 0;
+FILE	*f;
+
+	if (EId < 0)
+	   return false;
+	put (b, 'D', 1); put (b, 'A', 1); put (b, 'B', 1); put (b, 'E', 1);
+	put (b, CACHE_FORMAT, 1);
+	put (b, frequency, 4);
+	put (b, EId, 2);
+
+	for (i = 0; i < 64; i ++)
+	   if (subChannels [i]. inUse)
+	      n ++;
+	put (b, n, 1);
+	for (i = 0; i < 64; i ++) {
+	   const channelMap *sc = &subChannels [i];
+	   if (!sc -> inUse)
+	      continue;
+	   put (b, i, 1);
+	   put (b, sc -> StartAddr, 2);
+	   put (b, sc -> Length, 2);
+	   put (b, sc -> shortForm, 1);
+	   put (b, sc -> protLevel, 2);
+	   put (b, sc -> BitRate, 2);
+	   put (b, sc -> language, 2);
+	   put (b, sc -> FEC_scheme, 1);
+	}
+
+	put (b, services. size (), 2);
+	for (auto &s : services) {
+	   put (b, s. serviceId, 4);
+	   put (b, (s. serviceLabel. hasName ? 01 : 0) |
+	           (s. hasPNum ? 02 : 0) | (s. hasLanguage ? 04 : 0), 1);
+	   put (b, s. language, 2);
+	   put (b, s. programType, 1);
+	   put (b, s. pNum, 2);
+	   n	= s. serviceLabel. hasName ?
+	               std::min ((int)s. serviceLabel. label. size (), 255) : 0;
+	   put (b, n, 1);
+	   for (i = 0; i < n; i ++)
+	      put (b, (uint8_t)s. serviceLabel. label [i], 1);
+	}
+
+	put (b, components. size (), 2);
+	for (auto &c : components) {
+	   put (b, c. TMid, 1);
+	   put (b, c. SId, 4);
+	   put (b, c. componentNr, 1);
+	   put (b, c. ASCTy, 1);
+	   put (b, c. PS_flag, 1);
+	   put (b, c. subchannelId, 1);
+	   put (b, c. SCId, 2);
+	   put (b, c. CAflag, 1);
+	   put (b, c. DSCTy, 1);
+	   put (b, c. DGflag, 1);
+	   put (b, c. packetAddress, 2);
+	   put (b, c. appType, 2);
+	   put (b, c. is_madePublic, 1);
+	}
+
+	crc	= crc16_bytes (b. data (), b. size ()) ^ 0xFFFF;
+	put (b, crc, 2);
+//
+//	write to a temporary file first, so that a reader never sees
+//	a partially written cache
+	f	= fopen (tempName. c_str (), "wb");
+	if (f == nullptr)
+	   return false;
+	if (fwrite (b. data (), 1, b. size (), f) != b. size ()) {
+	   fclose (f);
+	   remove (tempName. c_str ());
+	   return false;
+	}
+	fclose (f);
+	return rename (tempName. c_str (), fileName. c_str ()) == 0;
+}
+//
+//	load replaces the contents of the database by the cached one,
+//	with all entries marked "not confirmed". If the file is absent,
+//	damaged or for another frequency, the database is untouched
+bool	ensembleDB::load	(const std::string &fileName,
+	                         int32_t frequency) {
+std::vector<uint8_t> b;
+uint8_t	buffer [1024];
+uint32_t	p	= 0;
+size_t	l;
+int32_t	i, j, n;
+FILE	*f	= fopen (fileName. c_str (), "rb");
+ensembleDB	cached;
+
+	if (f == nullptr)
+	   return false;
+	while ((l = fread (buffer, 1, sizeof (buffer), f)) > 0)
+	   b. insert (b. end (), buffer, buffer + l);
+	fclose (f);
+
+	if ((b. size () < 16) || !check_crc16_bytes (b. data (), b. size () - 2))
+	   return false;
+	b. resize (b. size () - 2);
+//
+//	the crc is fine, so apart from a programming error, the remaining
+//	checks are on the sizes only
+#define	NEED(n)	if (p + (n) > b. size ()) return false
+	if ((memcmp (b. data (), "DABE", 4) != 0) || (b [4] != CACHE_FORMAT))
+	   return false;
+	p	= 5;
+	if ((int32_t)get (b, p, 4) != frequency)
+	   return false;
+	cached. EId	= get (b, p, 2);
+
+	NEED (1);
+	n	= get (b, p, 1);
+	for (i = 0; i < n; i ++) {
+	   NEED (13);
+	   channelMap *sc	= &cached. subChannels [get (b, p, 1) & 077];
+	   sc -> inUse		= true;
+	   sc -> confirmed	= false;
+	   sc -> SubChId	= sc - cached. subChannels;
+	   sc -> StartAddr	= get (b, p, 2);
+	   sc -> Length		= get (b, p, 2);
+	   sc -> shortForm	= get (b, p, 1) != 0;
+	   sc -> protLevel	= (int16_t)get (b, p, 2);
+	   sc -> BitRate	= get (b, p, 2);
+	   sc -> language	= (int16_t)get (b, p, 2);
+	   sc -> FEC_scheme	= get (b, p, 1);
+	}
+
+	NEED (2);
+	n	= get (b, p, 2);
+	for (i = 0; i < n; i ++) {
+	   NEED (11);
+	   serviceId *s	= cached. addService (get (b, p, 4));
+	   if (s == nullptr)
+	      return false;
+	   uint8_t flags	= get (b, p, 1);
+	   s -> confirmed	= false;
+	   s -> hasPNum		= (flags & 02) != 0;
+	   s -> hasLanguage	= (flags & 04) != 0;
+	   s -> language	= (int16_t)get (b, p, 2);
+	   s -> programType	= get (b, p, 1);
+	   s -> pNum		= get (b, p, 2);
+	   l	= get (b, p, 1);
+	   NEED (l);
+	   if (flags & 01) {
+	      std::string label;
+	      for (j = 0; j < (int32_t)l; j ++)
+	         label. push_back ((char)get (b, p, 1));
+	      cached. setLabel (s, label);
+	      s -> serviceLabel. fromCache	= true;
+	   }
+	   else
+	      p += l;
+	}
+
+	NEED (2);
+	n	= get (b, p, 2);
+	for (i = 0; i < n; i ++) {
+	   serviceComponent c;
+	   NEED (19);
+	   memset (&c, 0, sizeof (c));
+	   c. TMid		= get (b, p, 1);
+	   c. SId		= get (b, p, 4);
+	   c. componentNr	= get (b, p, 1);
+	   c. ASCTy		= get (b, p, 1);
+	   c. PS_flag		= get (b, p, 1);
+	   c. subchannelId	= (int8_t)get (b, p, 1);
+	   c. SCId		= get (b, p, 2);
+	   c. CAflag		= get (b, p, 1);
+	   c. DSCTy		= get (b, p, 1);
+	   c. DGflag		= get (b, p, 1);
+	   c. packetAddress	= get (b, p, 2);
+	   c. appType		= (int16_t)get (b, p, 2);
+	   c. is_madePublic	= get (b, p, 1) != 0;
+	   c. confirmed		= false;
+	   if (cached. findService (c. SId) == nullptr)
+	      return false;
+	   if (cached. addComponent (c) == nullptr)
+	      return false;
+	}
+#undef	NEED
+	if (p != b. size ())
+	   return false;
+
+	cached. version	= version;
+	*this	= cached;
+	return true;
+}
+
+int32_t	ensembleDB::nrServices	(void) const {
+	return services. size ();
+}
+
+int32_t	ensembleDB::nrComponents	(void) const {
+	return components. size ();
+}
+
+std::string ensembleDB::nameFor (int32_t SId) const {
+const serviceId *s	= findService ((uint32_t)SId);
+
+	if ((s == nullptr) || !s -> serviceLabel. hasName)
+	   return "no service found";
+	return s -> serviceLabel. label;
+}
+
+int32_t	ensembleDB::SIdFor (const std::string &name) const {
+const serviceId *s	= findService (name);
+
+	return s == nullptr ? -1 : s -> serviceId;
+}
+//
+//	Here we look for a primary service only
+uint8_t	ensembleDB::kindofService (const std::string &name) const {
+const serviceId *s	= findService (name);
+const serviceComponent *c;
+
+	if (s == nullptr)
+	   return UNKNOWN_SERVICE;
+	c	= findComponent (s -> serviceId, 0);
+	if (c == nullptr)
+	   return UNKNOWN_SERVICE;
+	if (c -> TMid == 03)
+	   return PACKET_SERVICE;
+	if (c -> TMid == 00)
+	   return AUDIO_SERVICE;
+	return UNKNOWN_SERVICE;
+}
+
+void	ensembleDB::dataforDataService (const std::string &name,
+	                                packetdata *d,
+	                                int16_t compnr) const {
+const serviceId *s	= findService (name);
+const serviceComponent *c;
+
+	d	-> defined	= false;	// always a decent default
+	if (s == nullptr)
+	   return;
+	c	= findComponent (s -> serviceId, compnr);
+	if ((c == nullptr) || (c -> TMid != 03))
+	   return;
+	if ((c -> subchannelId < 0) || (c -> subchannelId >= 64))
+	   return;
+	fillPacketdata (c, d);
+}
+
+void	ensembleDB::dataforAudioService (const std::string &name,
+	                                 audiodata *d,
+	                                 int16_t compnr) const {
+const serviceId *s	= findService (name);
+const serviceComponent *c;
+
+	d	-> defined	= false;
+	if (s == nullptr)
+	   return;
+	c	= findComponent (s -> serviceId, compnr);
+	if ((c == nullptr) || (c -> TMid != 00))
+	   return;
+	fillAudiodata (c, s, d);
+}
+
+void	ensembleDB::fillAudiodata	(const serviceComponent *c,
+	                                 const serviceId *s,
+	                                 audiodata *d) const {
+int16_t	subchId	= c -> subchannelId;
+
+	d	-> subchId	= subchId;
+	d	-> startAddr	= subChannels [subchId]. StartAddr;
+	d	-> shortForm	= subChannels [subchId]. shortForm;
+	d	-> protLevel	= subChannels [subchId]. protLevel;
+	d	-> length	= subChannels [subchId]. Length;
+	d	-> bitRate	= subChannels [subchId]. BitRate;
+	d	-> ASCTy	= c -> ASCTy;
+	d	-> language	= s -> language;
+	d	-> programType	= s -> programType;
+	d	-> is_madePublic	= true;
+	d	-> defined	= true;
+}
+
+void	ensembleDB::fillPacketdata	(const serviceComponent *c,
+	                                 packetdata *d) const {
+int16_t	subchId	= c -> subchannelId;
+
+	d	-> subchId	= subchId;
+	d	-> startAddr	= subChannels [subchId]. StartAddr;
+	d	-> shortForm	= subChannels [subchId]. shortForm;
+	d	-> protLevel	= subChannels [subchId]. protLevel;
+	d	-> length	= subChannels [subchId]. Length;
+	d	-> bitRate	= subChannels [subchId]. BitRate;
+	d	-> FEC_scheme	= subChannels [subchId]. FEC_scheme;
+	d	-> DSCTy	= c -> DSCTy;
+	d	-> DGflag	= c -> DGflag;
+	d	-> packetAddress = c -> packetAddress;
+	d	-> appType	= c -> appType;
+	d	-> is_madePublic	= c -> is_madePublic;
+	d	-> defined	= true;
+}
+//
+//	describe tells whether the component is completely known, i.e.
+//	the subchannel is known and - for packet data - the FIG 0/3
+//	data is in, and if so fills in the descriptor
+bool	ensembleDB::describe	(const serviceComponent *c,
+	                         serviceDescriptor *desc) const {
+const serviceId	*s	= findService (c -> SId);
+int16_t	subchId		= c -> subchannelId;
+
+	if (s == nullptr)
+	   return false;
+	if ((c -> TMid == 03) && !c -> is_madePublic)
+	   return false;
+	if ((subchId < 0) || (subchId >= 64) || !subChannels [subchId]. inUse)
+	   return false;
+
+	desc	-> SId		= c -> SId;
+	desc	-> componentNr	= c -> componentNr;
+	desc	-> isAudio	= c -> TMid == 00;
+	if (desc -> isAudio)
+	   fillAudiodata (c, s, &desc -> ad);
+	else
+	if (c -> TMid == 03)
+	   fillPacketdata (c, &desc -> pd);
+	else
+	   return false;
+	return true;
+}
+
+void	ensembleDB::get_serviceList (std::vector<serviceDescriptor> &l) const {
+serviceDescriptor desc;
+
+	l. resize (0);
+	for (auto &c : components)
+	   if (describe (&c, &desc))
+	      l. push_back (desc);
+}
+
+int32_t	ensembleDB::enumerate	(ensembleComponent_t h, void *ctx) const {
+serviceDescriptor desc;
+ensembleComponent e;
+int32_t	n	= 0;
+
+	for (auto &c : components) {
+	   if (!describe (&c, &desc))
+	      continue;
+	   const serviceId *s	= findService (c. SId);
+	   e. SId		= desc. SId;
+	   e. label		= s -> serviceLabel. label. c_str ();
+	   e. componentNr	= desc. componentNr;
+	   e. isAudio		= desc. isAudio;
+	   e. ad		= desc. ad;
+	   e. pd		= desc. pd;
+	   e. pNum		= s -> hasPNum ? s -> pNum : 0;
+	   e. version		= version;
+	   if (h != nullptr)
+	      h (&e, ctx);
+	   n ++;
+	}
+	return n;
+}
+
+std::complex<float>	ensembleDB::get_coordinates (int16_t mainId,
+	                                        int16_t subId,
+	                                        bool *success) const {
+	coordinates. print_coordinates ();
+	return coordinates. get_coordinates (mainId, subId, success);
+}
+
+std::complex<float>
+	ensembleDB::get_coordinates (int16_t mainId,
+	                                int16_t subId, bool *success,
+	                                int16_t *pMainId,
+	                                int16_t *pSubId, int16_t *pTD) const {
+	return coordinates. get_coordinates (mainId, subId, success,
+	                                     pMainId, pSubId, pTD);
+}
+
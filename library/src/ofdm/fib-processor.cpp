@@ -105,6 +105,8 @@
 	this	-> programnameHandler	= programnameHandler;
 	this	-> userData		= userData;
 	memset (dateTime, 0, 8 * sizeof (uint32_t));
+	memset (figCache, 0, sizeof (figCache));
+	changeCount		= 0;
 
 	reset	();
 }
@@ -114,19 +116,33 @@
 //
 //	FIB's are segments of 256 bits. When here, they already
 //	passed the crc and we start unpacking into FIGs
-//	This is merely a dispatcher
+//	This is merely a dispatcher, FIGs seen before are skipped.
+//	FIG0/0 (the CIF count), FIG0/10 (date and time, the time handler
+//	is called for each occurrence) and FIG0/19 (announcements, state
+//	rather than database content) are always processed
 void	fib_processor::process_FIB (uint8_t *p, uint16_t fib) {
 uint8_t	FIGtype;
 int8_t	processedBytes	= 0;
 uint8_t	*d		= p;
+uint64_t	hash;
 
 	fibLocker. lock ();
 	(void)fib;
 	while (processedBytes  < 30) {
 	   FIGtype 		= getBits_3 (d, 0);
 	   uint8_t FIGlength    = getBits_5 (d, 3);
-           if ((FIGtype == 0x07) && (FIGlength == 0x3F))
-              return;
+	   if (FIGtype == 0x07)		// end marker or padding
+	      break;
+	   if (processedBytes + FIGlength + 1 > 30)	// corrupt
+	      break;
+
+	   hash	= 0;
+	   if ((FIGtype == 1) ||
+	       ((FIGtype == 0) && cacheable (getBits_5 (d, 8 + 3)))) {
+	      hash	= figHash (d, 8 * (FIGlength + 1));
+	      if (figSeen (hash))
+	         FIGtype = 0x07;		// i.e. skip
+	   }
 
 	   switch (FIGtype) {
 	      case 0:
@@ -147,13 +163,83 @@ uint8_t	*d		= p;
 //
 //	Thanks to Ronny Kunze, who discovered that I used
 //	a p rather than a d
+	   if (hash != 0)
+	      figRemember (hash);
 	   processedBytes += getBits_5 (d, 3) + 1;
 //	   processedBytes += getBits (p, 3, 5) + 1;
 	   d = p + processedBytes * 8;
 	}
+//
+//	at the end of the warm start, whatever was not confirmed goes
+	if ((warmFIBs > 0) && (-- warmFIBs == 0) && db. hasUnconfirmed ()) {
+	   db. prune ();
+	   databaseChanged ();
+	}
+	if (std::atomic_load (&snapshot) -> version != changeCount)
+	   publish ();
 	fibLocker. unlock ();
 }
 //
+//	FIG0 extensions that may be skipped when seen before
+bool	fib_processor::cacheable	(uint8_t extension) {
+	return (extension != 0) && (extension != 10) && (extension != 19);
+}
+//
+//	The FIG is a sequence of bits, one bit per byte, the number
+//	of bits is a multiple of 8, so it is taken 8 bytes at the time.
+//	A hash of 0 is used for "no hash"
+uint64_t	fib_processor::figHash (const uint8_t *d, int16_t bits) {
+uint64_t	h	= 0xcbf29ce484222325ULL;
+uint64_t	w;
+int16_t		i;
+
+	for (i = 0; i < bits; i += 8) {
+	   memcpy (&w, &d [i], sizeof (w));
+	   h	= (h ^ w) * 0x100000001b3ULL;
+	   h	^= h >> 29;
+	}
+	h	^= h >> 33;
+	h	*= 0xff51afd7ed558ccdULL;
+	h	^= h >> 33;
+	return h == 0 ? 1 : h;
+}
+//
+//	open addressing, with a short linear probe. Entries from an
+//	earlier generation count as free
+bool	fib_processor::figSeen	(uint64_t hash) {
+uint32_t	generation	= changeCount. load ();
+int16_t		i;
+
+	for (i = 0; i < 4; i ++) {
+	   figCacheEntry *e = &figCache [(hash + i) & (FIG_CACHE_SIZE - 1)];
+	   if (e -> generation != generation)
+	      return false;
+	   if (e -> hash == hash)
+	      return true;
+	}
+	return false;
+}
+
+void	fib_processor::figRemember	(uint64_t hash) {
+uint32_t	generation	= changeCount. load ();
+int16_t		i;
+figCacheEntry	*e;
+
+	for (i = 0; i < 4; i ++) {
+	   e	= &figCache [(hash + i) & (FIG_CACHE_SIZE - 1)];
+	   if ((e -> generation != generation) || (e -> hash == hash))
+	      break;
+	}
+	if (i == 4)		// full, overwrite the first one
+	   e	= &figCache [hash & (FIG_CACHE_SIZE - 1)];
+	e -> hash	= hash;
+	e -> generation	= generation;
+}
+
+void	fib_processor::databaseChanged	(void) {
+	changeCount. fetch_add (1);
+}
+//
 //	Handle ensemble is all through FIG0
 //
 void	fib_processor::process_FIG0 (uint8_t *d) {
@@ -279,6 +365,9 @@ uint8_t	extension	= getBits_5 (d, 8 + 3);
 //	FIG0/0 indicated a change in channel organization
 //	we are not equipped for that, so we just return
 //	control to the init
+//	The EId validates a database preloaded from the cache, a cache
+//	for another ensemble is dropped, and an announced change makes
+//	the cache stale
 void	fib_processor::FIG0Extension0 (uint8_t *d) {
 uint16_t	EId;
 uint8_t		changeflag;
@@ -287,12 +376,29 @@ int16_t		occurrenceChange;
 uint8_t	CN	= getBits_1 (d, 8 + 0);
 
 	(void)CN;
+	EId			= getBits (d, 16, 16);
+	if (db. EId != EId) {
+	   if (db. EId >= 0) {		// not the ensemble we expected
+	      clearEnsemble ();
+	      warmFIBs	= 0;
+	   }
+	   db. EId	= EId;
+	   databaseChanged ();
+	}
+	warmDB. reset ();		// the live ensemble takes over
+
 	changeflag	= getBits_2 (d, 16 + 16);
 	if (changeflag == 0)
 	   return;
 
-	EId			= getBits (d, 16, 16);
-	(void)EId;
+	cacheStale	= true;
+	if (warmFIBs > 0) {	// the cached data is no longer reliable
+	   warmFIBs	= 0;
+	   if (db. hasUnconfirmed ()) {
+	      db. prune ();
+	      databaseChanged ();
+	   }
+	}
 	highpart		= getBits_5 (d, 16 + 19) % 20;
 	(void)highpart;
 	lowpart			= getBits_8 (d, 16 + 24) % 250;
@@ -344,46 +450,55 @@ int16_t	SubChId		= getBits_6 (d, bitOffset);
 int16_t StartAdr	= getBits (d, bitOffset + 6, 10);
 int16_t	tabelIndex;
 int16_t	option, protLevel, subChanSize;
-static  int table_1 [] = {12, 8, 6, 4};
-static  int table_2 [] = {27, 21, 18, 15};
+static const int table_1 [] = {12, 8, 6, 4};
+static const int table_2 [] = {27, 21, 18, 15};
+channelMap	old	= db. subChannels [SubChId];
 
-	subChannels [SubChId]. StartAddr = StartAdr;
-	subChannels [SubChId]. inUse	 = true;
+	db. subChannels [SubChId]. StartAddr = StartAdr;
+	db. subChannels [SubChId]. inUse	 = true;
+	db. subChannels [SubChId]. confirmed = true;
 
 	if (getBits_1 (d, bitOffset + 16) == 0) {	// short form
 	   tabelIndex = getBits_6 (d, bitOffset + 18);
-	   subChannels [SubChId]. Length  	= ProtLevel [tabelIndex][0];
-	   subChannels [SubChId]. shortForm	= true;
-	   subChannels [SubChId]. protLevel	= ProtLevel [tabelIndex][1];
-	   subChannels [SubChId]. BitRate	= ProtLevel [tabelIndex][2];
+	   db. subChannels [SubChId]. Length  	= ProtLevel [tabelIndex][0];
+	   db. subChannels [SubChId]. shortForm	= true;
+	   db. subChannels [SubChId]. protLevel	= ProtLevel [tabelIndex][1];
+	   db. subChannels [SubChId]. BitRate	= ProtLevel [tabelIndex][2];
 	   bitOffset += 24;
 	}
 	else { 	// EEP long form
-	   subChannels [SubChId]. shortForm	= false;
+	   db. subChannels [SubChId]. shortForm	= false;
 	   option = getBits_3 (d, bitOffset + 17);
 	   if (option == 0) { 		// A Level protection
 	      protLevel = getBits_2 (d, bitOffset + 20);
 //
-	      subChannels [SubChId]. protLevel = protLevel;
+	      db. subChannels [SubChId]. protLevel = protLevel;
 	      subChanSize = getBits (d, bitOffset + 22, 10);
-	      subChannels [SubChId]. Length	= subChanSize;
-	      subChannels [SubChId]. BitRate	= subChanSize / table_1 [protLevel] * 8;
+	      db. subChannels [SubChId]. Length	= subChanSize;
+	      db. subChannels [SubChId]. BitRate	= subChanSize / table_1 [protLevel] * 8;
 	   }
 	   else			// option should be 001
 	   if (option == 001) {		// B Level protection
 	      protLevel				=
 	                                 getBits_2 (d, bitOffset + 20);
-	      subChannels [SubChId]. protLevel= protLevel + (1 << 2);
+	      db. subChannels [SubChId]. protLevel= protLevel + (1 << 2);
 	      subChanSize			=
 	                                 getBits (d, bitOffset + 22, 10);
-	      subChannels [SubChId]. Length	=
+	      db. subChannels [SubChId]. Length	=
 	                                 subChanSize;
-	      subChannels [SubChId]. BitRate	= 
+	      db. subChannels [SubChId]. BitRate	= 
 	                                 subChanSize /table_2 [protLevel] * 32;
 	   }
 
 	   bitOffset += 32;
 	}
+	if (!old. inUse ||
+	    (old. StartAddr != db. subChannels [SubChId]. StartAddr) ||
+	    (old. Length    != db. subChannels [SubChId]. Length) ||
+	    (old. shortForm != db. subChannels [SubChId]. shortForm) ||
+	    (old. protLevel != db. subChannels [SubChId]. protLevel) ||
+	    (old. BitRate   != db. subChannels [SubChId]. BitRate))
+	   databaseChanged ();
 	return bitOffset / 8;	// we return bytes
 }
 //
@@ -487,16 +602,22 @@ serviceId	 *service;
            return used;
 
 //      We want to have the subchannel OK
-	if (!subChannels [SubChId]. inUse)
+	if (!db. subChannels [SubChId]. inUse)
 	   return used;
 
 //      If the component exists, we first look whether is
-//      was already handled
-        if (packetComp -> is_madePublic)
+//      was already handled (a component from the cache is, but
+//      with possibly outdated data)
+        if (packetComp -> is_madePublic &&
+	    (packetComp -> subchannelId == SubChId) &&
+	    (packetComp -> DSCTy == DSCTy) &&
+	    (packetComp -> DGflag == DGflag) &&
+	    (packetComp -> packetAddress == packetAddress))
            return used;
+	bool	announce	= !packetComp -> is_madePublic;
 //
 //      We want to have the subchannel OK
-        if (!subChannels [SubChId]. inUse)
+        if (!db. subChannels [SubChId]. inUse)
            return used;
 
 //      if the  Data Service Component Type == 0, we do not deal
@@ -504,16 +625,17 @@ serviceId	 *service;
         if (DSCTy == 0)
            return used;
 
-	service = packetComp -> service;
-        std::string serviceName = service -> serviceLabel. label;
-        if (packetComp -> componentNr == 0)     // otherwise sub component
-           addtoEnsemble (serviceName, service -> serviceId);
-
         packetComp      -> is_madePublic = true;
         packetComp      -> subchannelId = SubChId;
         packetComp      -> DSCTy        = DSCTy;
 	packetComp	-> DGflag	= DGflag;
         packetComp      -> packetAddress        = packetAddress;
+	databaseChanged ();
+
+	service = db. findService (packetComp -> SId);
+        std::string serviceName = service -> serviceLabel. label;
+        if (announce && (packetComp -> componentNr == 0))     // otherwise sub component
+           addtoEnsemble (serviceName, service -> serviceId);
         return used;
 }
 //
@@ -548,7 +670,10 @@ int16_t	subChId, serviceComp, language;
 	   if (getBits_1 (d, loffset + 1) == 0) {
 	      subChId	= getBits_6 (d, loffset + 2);
 	      language	= getBits_8 (d, loffset + 8);
-	      subChannels [subChId]. language = language;
+	      if (db. subChannels [subChId]. language != language) {
+	         db. subChannels [subChId]. language = language;
+	         databaseChanged ();
+	      }
 	   }
 	   loffset += 16;
 	}
@@ -717,8 +842,10 @@ int16_t		appType;
 	   lOffset += (11 + 5 + 8 * length);
 	   serviceComponent *packetComp        =
 	                         find_serviceComponent (SId, SCIdS);
-	   if (packetComp != nullptr) 
+	   if ((packetComp != nullptr) && (packetComp -> appType != appType)) {
 	      packetComp      -> appType       = appType;
+	      databaseChanged ();
+	   }
 	}
 
 	return lOffset / 8;
@@ -735,8 +862,10 @@ int16_t	i;
 	   uint8_t FEC_scheme	= getBits_2 (d, used * 8 + 6);
 	   used = used + 1;
 	   for (i = 0; i < 64; i ++) {
-              if (subChannels [i]. SubChId == SubChId) {
-                 subChannels [i]. FEC_scheme = FEC_scheme;
+              if ((db. subChannels [i]. SubChId == SubChId) &&
+	          (db. subChannels [i]. FEC_scheme != FEC_scheme)) {
+                 db. subChannels [i]. FEC_scheme = FEC_scheme;
+	         databaseChanged ();
               }
            }
 	}
@@ -755,10 +884,11 @@ serviceId	*s;
 	while (offset < length * 8) {
 	   uint16_t	SId	= getBits (d, offset, 16);
 	   s	= findServiceId (SId);
-	   if (!s -> hasPNum) {
+	   if ((s != nullptr) && !s -> hasPNum) {
 	      uint8_t PNum = getBits (d, offset + 16, 16);
 	      s -> pNum		= PNum;
 	      s -> hasPNum	= true;
+	      databaseChanged ();
 //	      fprintf (stderr, "Program number info SId = %.8X, PNum = %d\n",
 //	      	                               SId, PNum);
 	   }
@@ -779,15 +909,23 @@ serviceId	*s;
 	   int16_t type;
 	   int16_t Language = 0x00;	// init with unknown language
 	   s	= findServiceId (SId);
+	   if (s == nullptr)
+	      break;
 	   if (L_flag) {		// language field present
 	      Language = getBits_8 (d, offset + 24);
-	      s -> language = Language;
-	      s -> hasLanguage = true;
+	      if (!s -> hasLanguage || (s -> language != Language)) {
+	         s -> language = Language;
+	         s -> hasLanguage = true;
+	         databaseChanged ();
+	      }
 	      offset += 8;
 	   }
 
 	   type	= getBits_5 (d, offset + 27);
-	   s	-> programType	= type;
+	   if (s -> programType != type) {
+	      s	-> programType	= type;
+	      databaseChanged ();
+	   }
 	   if (CC_flag)			// cc flag
 	      offset += 40;
 	   else
@@ -884,9 +1022,10 @@ int	i;
 	   int16_t latitudeCoarse = getBits (d, used * 8 + 8, 16);
 	   int16_t longitudeCoarse = getBits (d, used * 8 + 24, 16);
 
-	   coordinates. add_main (mainId,
+	   if (db. coordinates. add_main (mainId,
 	                          latitudeCoarse * 90.0 / 32768.0,
-	                          longitudeCoarse * 180.0 / 32768.0);
+	                          longitudeCoarse * 180.0 / 32768.0))
+	      databaseChanged ();
 	   return used + 48 / 6;
 	}
 
@@ -900,7 +1039,8 @@ int	i;
 	   tii_element s (subId, TD,
 	                        latOff * 90 / (16 * 32768.0),
 	                        lonOff * 180 / (16 * 32768.0));
-	   coordinates. add_element (&s);
+	   if (db. coordinates. add_element (&s))
+	      databaseChanged ();
 	}
 	   
 	used += (16 + noSubfields * 48) / 8;
@@ -967,8 +1107,10 @@ char		label [17];
 	            std::string name = toStringUsingCharset (
 	                                      (const char *) label,
 	                                      (CharacterSet) charSet);
-	            if (firstTime)
+	            if (firstTime) {
+	               databaseChanged ();
 	               nameofEnsemble (SId, name);
+	            }
 	            firstTime	= false;
 	            isSynced	= true;
 	         }
@@ -981,17 +1123,26 @@ char		label [17];
 	      SId	= getBits (d, 16, 16);
 	      offset	= 32;
 	      myIndex	= findServiceId (SId);
-	      if ((!myIndex -> serviceLabel. hasName) && (charSet <= 16)) {
+	      if ((myIndex != nullptr) &&
+	          (!myIndex -> serviceLabel. hasName ||
+	                            myIndex -> serviceLabel. fromCache) &&
+	          (charSet <= 16)) {
 	         for (i = 0; i < 16; i ++) {
 	            label [i] = getBits_8 (d, offset + 8 * i);
 	         }
-
-	         myIndex -> serviceLabel. label. append (
-	                       toStringUsingCharset (
+	         {
+	            std::string name = toStringUsingCharset (
 	                                (const char *) label,
-	                                (CharacterSet) charSet));
+	                                (CharacterSet) charSet);
+	            if (myIndex -> serviceLabel. hasName &&
+	                (myIndex -> serviceLabel. label == name)) {
+	               myIndex -> serviceLabel. fromCache = false;
+	               break;
+	            }
+	            db. setLabel (myIndex, name);
+	         }
 //	         fprintf (stderr, "FIG1/1: SId = %4x\t%s\n", SId, label);
-	         myIndex -> serviceLabel. hasName = true;
+	         databaseChanged ();
 	      }
 	      break;
 
@@ -1030,19 +1181,28 @@ char		label [17];
 	      SId	= getLBits (d, 16, 32);
 	      offset	= 48;
 	      myIndex   = findServiceId (SId);
-              if ((!myIndex -> serviceLabel. hasName) && (charSet <= 16)) {
+              if ((myIndex != nullptr) &&
+	          (!myIndex -> serviceLabel. hasName ||
+	                            myIndex -> serviceLabel. fromCache) &&
+	          (charSet <= 16)) {
                  for (i = 0; i < 16; i ++) {
                     label [i] = getBits_8 (d, offset + 8 * i);
                  }
-                 myIndex -> serviceLabel. label. append (
-                               toStringUsingCharset (
+	         {
+	            std::string name = toStringUsingCharset (
                                          (const char *) label,
-                                         (CharacterSet) charSet));
-	         myIndex -> serviceLabel. label. append (
+                                         (CharacterSet) charSet) +
                                toStringUsingCharset (
 	                                 " (data)",
-                                         (CharacterSet) charSet));
-                 myIndex -> serviceLabel. hasName = true;
+                                         (CharacterSet) charSet);
+	            if (myIndex -> serviceLabel. hasName &&
+	                (myIndex -> serviceLabel. label == name)) {
+	               myIndex -> serviceLabel. fromCache = false;
+	               break;
+	            }
+	            db. setLabel (myIndex, name);
+	         }
+	         databaseChanged ();
 	         addtoEnsemble (myIndex -> serviceLabel. label, SId);
               }
 	      break;
@@ -1077,110 +1237,28 @@ char		label [17];
 	(void)flagfield;
 }
 
-#define	FULL_MATCH	0100
-#define	PREFIX_MATCH	0200
-#define	NO_MATCH	0000
-
-//	tricky: the names in the directoty contain spaces at the end
-static
-int	compareNames (std::string in, std::string ref) {
-
-	if (ref == in)
-	   return FULL_MATCH;
-
-	if (ref. length () < in. length ())
-	   return NO_MATCH;
-
-	if (ref. find (in, 0) != 0) 
-	   return NO_MATCH;
-
-	if  (in. length () == ref. length ())
-	   return FULL_MATCH;
-//
-//	Most likely we will find a prefix as match, since the
-//	FIC structure fills the service names woth spaces to 16 letters
-	if (ref. at (in. length ()) == ' ')
-	   return FULL_MATCH;
-
-	return PREFIX_MATCH;
-}
-
 //	locate - and create if needed - a reference to the entry
-//	for the serviceId serviceId
-serviceId	*fib_processor::findServiceId (int32_t serviceId) {
-int16_t	i;
-
-	for (i = 0; i < 64; i ++)
-	   if ((listofServices [i]. inUse) &&
-	        (listofServices [i]. serviceId == (uint32_t)serviceId))
-	      return &listofServices [i];
-
-	for (i = 0; i < 64; i ++)
-	   if (!listofServices [i]. inUse) {
-	      listofServices [i]. inUse = true;
-	      listofServices [i]. serviceLabel. hasName = false;
-	      listofServices [i]. serviceId = serviceId;
-	      listofServices [i]. language = -1;
-	      return &listofServices [i];
-	   }
+//	for the serviceId serviceId, nullptr if the database is full
+//	(being mentioned in the FIC confirms a service from the cache)
+serviceId	*fib_processor::findServiceId (int32_t SId) {
+int32_t	n	= db. nrServices ();
+serviceId *s	= db. addService ((uint32_t)SId);
 
-	return &listofServices [0];	// should not happen
-}
-//
-//	since some servicenames are long, we allow selection of a
-//	service based on the first few letters/digits of the name.
-//	However, in case of servicenames where one is a prefix
-//	of the other, the full match should have precedence over the
-//	prefix match
-serviceId	*fib_processor::findServiceId (std::string serviceName) {
-int16_t	i;
-int	indexforprefixMatch	= -1;
-
-	for (i = 0; i < 64; i ++) {
-	   if (listofServices [i]. inUse) {
-	      int res = compareNames (serviceName,
-	                     listofServices [i]. serviceLabel. label);
-	      if (res == FULL_MATCH) {
-	         return &listofServices [i];
-	      }
-	      if (res == PREFIX_MATCH) {
-	         indexforprefixMatch = i;
-	      }
-	   }
-	}
-
-	return indexforprefixMatch >= 0 ?
-	              &listofServices [indexforprefixMatch] : nullptr;
+	if (db. nrServices () != n)
+	   databaseChanged ();
+	if (s != nullptr)
+	   s -> confirmed = true;
+	return s;
 }
 
 serviceComponent *fib_processor::find_packetComponent (int16_t SCId) {
-int16_t i;
-
-        for (i = 0; i < 64; i ++) {
-           if (!ServiceComps [i]. inUse)
-              continue;
-           if (ServiceComps [i]. TMid != 03)
-              continue;
-           if (ServiceComps [i]. SCId == SCId)
-              return &ServiceComps [i];
-        }
-        return nullptr;
+	return db. findPacketComponent (SCId);
 }
-
+//
+//	the SCIdS is taken as the number of the component in the FIG 0/2
 serviceComponent *fib_processor::find_serviceComponent (int32_t SId,
 	                                                int16_t SCIdS) {
-int16_t i;
-
-	for (i = 0; i < 64; i ++) {
-	   if (!ServiceComps [i]. inUse)
-	      continue;
-
-	   if ( (findServiceId (SId) == ServiceComps [i]. service)) {
-	      return &ServiceComps [i];
-	   }
-	}
-
-	return nullptr;
+	return db. findComponent ((uint32_t)SId, SCIdS);
 }
 
 //	bind_audioService is the main processor for - what the name suggests -
@@ -1192,36 +1270,46 @@ void	fib_processor::bind_audioService (int8_t TMid,
 	                                  int16_t ps_flag,
 	                                  int16_t ASCTy) {
 serviceId *s	= findServiceId	(SId);
-int16_t	i;
-int16_t	firstFree	= -1;
+serviceComponent *old;
+serviceComponent c;
 
-	if (!s -> serviceLabel. hasName)
+	if ((s == nullptr) || !s -> serviceLabel. hasName)
 	   return;
 
-	if (!subChannels [SubChId]. inUse)
+	if (!db. subChannels [SubChId]. inUse)
 	   return;
-
-	for (i = 0; i < 64; i ++) {
-	   if (!ServiceComps [i]. inUse) {
-	      if (firstFree == -1)
-	         firstFree = i;
-	      continue;
+//
+//	a component from the cache is confirmed - and if needed
+//	updated - but not announced again
+	old	= db. findComponent (SId, compnr);
+	if (old != nullptr) {
+	   if (!old -> confirmed &&
+	       ((old -> TMid != TMid) || (old -> subchannelId != SubChId) ||
+	        (old -> PS_flag != ps_flag) || (old -> ASCTy != ASCTy))) {
+	      old -> TMid		= TMid;
+	      old -> subchannelId	= SubChId;
+	      old -> PS_flag		= ps_flag;
+	      old -> ASCTy		= ASCTy;
+	      databaseChanged ();
 	   }
-	   if ((ServiceComps [i]. service == s) &&
-               (ServiceComps [i]. componentNr == compnr))
-	      return;
+	   old -> confirmed	= true;
+	   return;
 	}
 
+	memset (&c, 0, sizeof (c));
+	c. TMid		= TMid;
+	c. SId		= SId;
+	c. componentNr	= compnr;
+	c. subchannelId	= SubChId;
+	c. PS_flag	= ps_flag;
+	c. ASCTy	= ASCTy;
+	c. confirmed	= true;
+	if (db. addComponent (c) == nullptr)
+	   return;
+	databaseChanged ();
+
 	std::string dataName = s -> serviceLabel. label;
         addtoEnsemble (dataName, s -> serviceId);
-
-	ServiceComps [firstFree]. inUse		= true;
-	ServiceComps [firstFree]. TMid		= TMid;
-	ServiceComps [firstFree]. componentNr	= compnr;
-	ServiceComps [firstFree]. service	= s;
-	ServiceComps [firstFree]. subchannelId = SubChId;
-	ServiceComps [firstFree]. PS_flag	= ps_flag;
-	ServiceComps [firstFree]. ASCTy		= ASCTy;
 }
 
 //      bind_packetService is the main processor for - what the name suggests -
@@ -1234,156 +1322,88 @@ void    fib_processor::bind_packetService (int8_t TMid,
                                            int16_t ps_flag,
                                            int16_t CAflag) {
 serviceId *s    = findServiceId (SId);
-int16_t i;
-int16_t	firstFree	= -1;
+serviceComponent *old;
+serviceComponent c;
 
-	if (!s -> serviceLabel. hasName)        // wait until we have a name
-           return;
+	if ((s == nullptr) || !s -> serviceLabel. hasName)
+           return;		// wait until we have a name
 
-	for (i = 0; i < 64; i ++) {
-	   if ((ServiceComps [i]. inUse) &&
-	                      (ServiceComps [i]. SCId == SCId))
+//
+//	a component from the cache is confirmed - and if needed
+//	updated - but not announced again. If the cached SCId belongs
+//	to another service now, it remains unconfirmed and is pruned
+	old	= db. findPacketComponent (SCId);
+	if (old != nullptr) {
+	   if (old -> confirmed)
 	      return;
-
-	   if (!ServiceComps [i]. inUse) {
-	      if (firstFree == -1)
-	         firstFree = i;
-	      continue;
+	   if ((old -> SId != SId) || (old -> componentNr != compnr))
+	      return;
+	   if ((old -> PS_flag != ps_flag) || (old -> CAflag != CAflag)) {
+	      old -> PS_flag	= ps_flag;
+	      old -> CAflag	= CAflag;
+	      databaseChanged ();
 	   }
+	   old -> confirmed	= true;
+	   return;
 	}
 
-	ServiceComps [firstFree]. inUse  = true;
-	ServiceComps [firstFree]. TMid   = TMid;
-	ServiceComps [firstFree]. service = s;
-	ServiceComps [firstFree]. componentNr = compnr;
-	ServiceComps [firstFree]. SCId   = SCId;
-	ServiceComps [firstFree]. PS_flag = ps_flag;
-	ServiceComps [firstFree]. CAflag = CAflag;
-	ServiceComps [firstFree]. is_madePublic = false;
+	memset (&c, 0, sizeof (c));
+	c. TMid		= TMid;
+	c. SId		= SId;
+	c. componentNr	= compnr;
+	c. subchannelId	= -1;		// comes with the FIG 0/3
+	c. SCId		= SCId;
+	c. PS_flag	= ps_flag;
+	c. CAflag	= CAflag;
+	c. is_madePublic = false;
+	c. confirmed	= true;
+	if (db. addComponent (c) == nullptr)
+	   return;
+	databaseChanged ();
 }
 
 void	fib_processor::setupforNewFrame (void) {
-int16_t	i;
 	isSynced	= false;
-	for (i = 0; i < 64; i ++)
-	   ServiceComps [i]. inUse = false;
+	db. clearComponents ();
+	databaseChanged ();
+	publish ();
 }
 
 void	fib_processor::clearEnsemble (void) {
-int16_t i;
-
 	setupforNewFrame ();
-	coordinates. cleanUp ();
-	memset (ServiceComps, 0, sizeof (ServiceComps));
-	memset (subChannels, 0, sizeof (subChannels));
-	for (i = 0; i < 64; i ++) {
-	   listofServices [i]. inUse = false;
-	   listofServices [i]. serviceId = -1;
-	   listofServices [i]. serviceLabel. label = "";
-	   ServiceComps [i]. inUse	= false;
-	   subChannels [i]. inUse	= false;
-	}
+	db. clear ();
 	firstTime	= true;
+	publish ();
 }
 
-std::string fib_processor::nameFor (int32_t serviceId) {
-int16_t i;
-
-	for (i = 0; i < 64; i ++) {
-	   if (!listofServices [i]. inUse)
-	      continue;
-
-	   if (!listofServices [i]. serviceLabel. hasName)
-              continue;
+//
+//	Copy the database into a new snapshot and make that the
+//	current one. Readers still holding the previous one keep it
+//	until they are done with it.
+//	Called with the database stable, i.e. from the FIC thread
+void	fib_processor::publish	(void) {
+ensembleDB *s	= new ensembleDB (db);
 
-	   if (listofServices [i]. serviceId == (uint32_t) serviceId) {
-	      return listofServices [i]. serviceLabel. label;
-	   }
-	}
-	return "no service found";
+	s	-> version	= changeCount;
+	std::atomic_store (&snapshot,
+	                   std::shared_ptr<const ensembleDB> (s));
 }
 
-int32_t	fib_processor::SIdFor (std::string &name) {
-int16_t i;
-int	serviceIndex	= -1;
-
-	for (i = 0; i < 64; i ++) {
-	   if (!listofServices [i]. inUse)
-	      continue;
-
-	   if (!listofServices [i]. serviceLabel. hasName)
-              continue;
-
-	   int res = compareNames (name,
-	                      listofServices [i]. serviceLabel. label);
-	   if (res == NO_MATCH)
-	      continue;
-	   if (res == PREFIX_MATCH) {
-	      serviceIndex = i;
-	      continue;
-	   }
-//	it is a FULL match:
-	   return listofServices [i]. serviceId;
-	}
-	if (serviceIndex >= 0)
-	   return listofServices [serviceIndex]. serviceId;
-	return -1;
+std::shared_ptr<const ensembleDB>
+	fib_processor::get_snapshot	(void) const {
+	return std::atomic_load (&snapshot);
 }
-//
-//	Here we look for a primary service only
-uint8_t	fib_processor::kindofService (std::string &s) {
-int16_t	i, j;
-int16_t	service		= UNKNOWN_SERVICE;
-int32_t	selectedService = -1;
-int	serviceIndex	= -1;
 
-	fibLocker. lock ();
-//	first we locate the serviceId
-	for (i = 0; i < 64; i ++) {
-	   int	res;
-	   if (!listofServices [i]. inUse)
-	      continue;
-
-	   if (!listofServices [i]. serviceLabel. hasName)
-	      continue;
-
-	   res = compareNames (s,
-	                listofServices [i]. serviceLabel. label);
-	   if (res == NO_MATCH)
-	      continue;
-	   if (res == PREFIX_MATCH) {
-	      serviceIndex = i;
-	      continue;
-	   }
-	   serviceIndex = i;
-	   break;
-	}
-
-	if (serviceIndex != -1) {
-	   selectedService = listofServices [serviceIndex]. serviceId;
-	   for (j = 0; j < 64; j ++) {
-	      if (!ServiceComps [j]. inUse)
-	         continue;
-	      if ((uint32_t)selectedService !=
-	                           ServiceComps [j]. service -> serviceId)
-	         continue;
-
-	      if (ServiceComps [j]. componentNr != 0)
-	         continue;
+std::string fib_processor::nameFor	(int32_t serviceId) {
+	return get_snapshot () -> nameFor (serviceId);
+}
 
-	      if (ServiceComps [j]. TMid == 03) {
-	         service = PACKET_SERVICE;
-	         break;
-	      }
+int32_t	fib_processor::SIdFor	(std::string &name) {
+	return get_snapshot () -> SIdFor (name);
+}
 
-	      if (ServiceComps [j]. TMid == 00) {
-	         service = AUDIO_SERVICE;
-	         break;
-	      }
-	   }
-	}
-	fibLocker. unlock ();
-	return service;
+uint8_t	fib_processor::kindofService	(std::string &s) {
+	return get_snapshot () -> kindofService (s);
 }
 
 void	fib_processor::dataforDataService (std::string &s, packetdata *d) {
@@ -1391,48 +1411,8 @@ void	fib_processor::dataforDataService (std::string &s, packetdata *d) {
 }
 
 void	fib_processor::dataforDataService (std::string &s,
-	                                   packetdata *d,
-	                                   int16_t compnr) {
-int16_t	j;
-serviceId *selectedService;
-
-
-	d	-> defined	= false;	// always a decent default
-	fibLocker. lock ();
-	selectedService = findServiceId (s);
-	if (selectedService == nullptr) {
-	   fibLocker. unlock ();
-	   return;
-	}
-
-	for (j = 0; j < 64; j ++) {
-	   int16_t subchId;
-	   if ((!ServiceComps [j]. inUse) ||
-	                        (ServiceComps [j]. TMid != 03)) 
-	      continue;
-
-	   if (ServiceComps [j]. componentNr != compnr)
-	      continue;
-
-	   if (selectedService != ServiceComps [j]. service)
-	      continue;
-
-	   subchId		= ServiceComps [j]. subchannelId;
-	   d	-> subchId	= subchId;
-	   d	-> startAddr	= subChannels [subchId]. StartAddr;
-	   d	-> shortForm	= subChannels [subchId]. shortForm;
-	   d	-> protLevel	= subChannels [subchId]. protLevel;
-	   d	-> length	= subChannels [subchId]. Length;
-	   d	-> bitRate	= subChannels [subchId]. BitRate;
-	   d	-> FEC_scheme	= subChannels [subchId]. FEC_scheme;
-	   d	-> DSCTy	= ServiceComps [j]. DSCTy;
-	   d	-> DGflag	= ServiceComps [j]. DGflag;
-	   d	-> packetAddress = ServiceComps [j]. packetAddress;
-	   d	-> appType	= ServiceComps [j]. appType;
-	   d	-> defined	= true;
-	   break;
-	}
-	fibLocker. unlock ();
+	                                   packetdata *d, int16_t compnr) {
+	get_snapshot () -> dataforDataService (s, d, compnr);
 }
 
 void	fib_processor::dataforAudioService (std::string &s, audiodata *d) {
@@ -1441,50 +1421,23 @@ void	fib_processor::dataforAudioService (std::string &s, audiodata *d) {
 
 void	fib_processor::dataforAudioService (std::string &s,
 	                                    audiodata *d, int16_t compnr) {
-int16_t	j;
-serviceId *selectedService;
+	get_snapshot () -> dataforAudioService (s, d, compnr);
+}
 
-	d -> defined	= false;
-	fibLocker. lock ();
-	selectedService	= findServiceId (s);
-	if (selectedService == nullptr) {
-	   fibLocker. unlock ();
-	   return;
-	}
+void	fib_processor::get_serviceList (std::vector<serviceDescriptor> &l) {
+	get_snapshot () -> get_serviceList (l);
+}
 
-//	first we locate the serviceId
-	for (j = 0; j < 64; j ++) {
-	   int16_t subchId;
-	   if ((!ServiceComps [j]. inUse) ||
-	                        (ServiceComps [j]. TMid != 00))
-	      continue;
-
-	   if (ServiceComps [j]. componentNr != compnr)
-	      continue;
-
-	   if (selectedService != ServiceComps [j]. service)
-	      continue;
-
-	   subchId		= ServiceComps [j]. subchannelId;
-	   d	-> subchId	= subchId;
-	   d	-> startAddr	= subChannels [subchId]. StartAddr;
-	   d	-> shortForm	= subChannels [subchId]. shortForm;
-	   d	-> protLevel	= subChannels [subchId]. protLevel;
-	   d	-> length	= subChannels [subchId]. Length;
-	   d	-> bitRate	= subChannels [subchId]. BitRate;
-	   d	-> ASCTy	= ServiceComps [j]. ASCTy;
-	   d	-> language	= selectedService -> language;
-	   d	-> programType	= selectedService -> programType;
-	   d	-> defined	= true;
-	   break;
-	}
-	fibLocker. unlock ();
+int32_t	fib_processor::enumerate (ensembleComponent_t h, void *ctx) {
+	return get_snapshot () -> enumerate (h, ctx);
 }
 //
 //	and now for the would-be signals
 //	Note that the main program may decide to execute calls
-//	in the fib structures, so release the lock
+//	in the fib structures, so release the lock. The calls are
+//	answered from the snapshot, so that one is brought up to date first
 void	fib_processor::addtoEnsemble	(const std::string &s, int32_t SId) {
+	publish ();
 	fibLocker. unlock ();
 	if (programnameHandler != nullptr)
 	   programnameHandler (s, SId, userData);
@@ -1509,8 +1462,7 @@ bool	fib_processor::syncReached	(void) {
 std::complex<float>	fib_processor::get_coordinates (int16_t mainId,
 	                                        int16_t subId,
 	                                        bool *success) {
-	coordinates. print_coordinates ();
-	return coordinates. get_coordinates (mainId, subId, success);
+	return get_snapshot () -> get_coordinates (mainId, subId, success);
 }
 
 
@@ -1522,7 +1474,8 @@ std::complex<float>
 	                                int16_t subId, bool *success,
 	                                int16_t *pMainId,
 	                                int16_t *pSubId, int16_t *pTD) {
-	return coordinates. get_coordinates (mainId, subId, success, pMainId, pSubId, pTD);
+	return get_snapshot () -> get_coordinates (mainId, subId, success,
+	                                           pMainId, pSubId, pTD);
 }
 
 uint8_t	fib_processor::getECC	(bool *success) {
@@ -1539,15 +1492,81 @@ void	fib_processor::reset	(void) {
 	dateFlag		= false;
 	ecc_Present             = false;
         interTab_Present        = false;
+	fibLocker. lock ();
 	clearEnsemble	();
+	warmFIBs	= 0;
+	cacheStale	= false;
+	if (warmDB != nullptr)		// preloaded before the restart
+	   applyWarmDB ();
+	fibLocker. unlock ();
 	CIFcount	= 0;
 	hasCIFcount	= false;
 }
+//
+//	preload installs a database from the cache, to be confirmed
+//	by the FIC. It is kept until the first FIG0/0 is seen, so that
+//	a restart of the processing (e.g. after a retune) in between
+//	installs it again. nullptr just drops a pending one
+void	fib_processor::preload	(std::shared_ptr<const ensembleDB> cached) {
+std::shared_ptr<const ensembleDB> s;
+std::vector<serviceDescriptor> l;
+
+	fibLocker. lock ();
+	warmDB	= cached;
+	if (warmDB != nullptr) {
+	   clearEnsemble ();
+	   applyWarmDB ();
+	}
+	fibLocker. unlock ();
+	if ((cached == nullptr) || (programnameHandler == nullptr))
+	   return;
+//
+//	the services are announced as if they came from the FIC,
+//	outside the lock since the client may query the database
+	s	= get_snapshot ();
+	s	-> get_serviceList (l);
+	for (auto &desc : l)
+	   if (desc. componentNr == 0)
+	      programnameHandler (s -> nameFor (desc. SId),
+	                          desc. SId, userData);
+}
+//
+//	with the lock held
+void	fib_processor::applyWarmDB	(void) {
+	db		= *warmDB;
+	db. coordinates. cleanUp ();
+	warmFIBs	= WARM_START_FIBS;
+	databaseChanged ();
+	publish ();
+}
+//
+//	The database is worth saving when the ensemble is known and
+//	the warm start - if any - is over. The snapshot does not change,
+//	so it can be written by another thread
+std::shared_ptr<const ensembleDB>
+	fib_processor::ensembleToSave	(void) {
+std::shared_ptr<const ensembleDB> s;
+
+	if (warmFIBs > 0)
+	   return nullptr;
+	s	= get_snapshot ();
+	if ((s -> EId < 0) || (s -> nrServices () == 0))
+	   return nullptr;
+	return s;
+}
+
+bool	fib_processor::cacheIsStale	(void) {
+	return cacheStale. exchange (false);
+}
 
 int32_t		fib_processor::get_CIFcount (void) const {
 	return CIFcount;
 }
 
+uint32_t	fib_processor::get_changeCount (void) const {
+	return changeCount;
+}
+
 bool		fib_processor::has_CIFcount (void) const {
 	return hasCIFcount;
 }
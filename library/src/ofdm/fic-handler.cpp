@@ -19,8 +19,8 @@
  */
 
 #include	"fic-handler.h"
-#include	"msc-handler.h"
 #include	"protTables.h"
+#include	"crc-handler.h"
 //
 //	The 3072 bits of the serial motherword shall be split into
 //	24 blocks of 128 bits each.
@@ -59,6 +59,8 @@ int16_t	local	= 0;
 	ficBlocks	= 0;
 	ficMissed	= 0;
 	ficRatio	= 0;
+	ficCRC_ok	= 0;
+	ficCRC_count	= 0;
 	memset (shiftRegister, 1, 9);
 
 	for (i = 0; i < 768; i ++) {
@@ -125,8 +127,10 @@ int16_t	local	= 0;
   *	
   *	The function is called with a blkno. This should be 1, 2 or 3
   *	for each time 2304 bits are in, we call process_ficInput
+  *	data points to the BitsperBlock soft bits of the block, they
+  *	are copied, so the caller's buffer can be reused immediately
   */
-void	ficHandler::process_ficBlock (std::vector<int16_t> data,
+void	ficHandler::process_ficBlock (const int16_t *data,
 	                              int16_t blkno) {
 int32_t	i;
 
@@ -193,7 +197,7 @@ int16_t	inputCount	= 0;
   */
 	for (i = ficno * 3; i < ficno * 3 + 3; i ++) {
 	   uint8_t *p = &bitBuffer_out [(i % 3) * 256];
-	   if (!check_CRC_bits (p, 256)) {
+	   if (!check_crc16_bits (p, 256)) {
 	      show_ficCRC (false);
 	      continue;
 	   }
@@ -210,24 +214,41 @@ void	ficHandler::clearEnsemble (void) {
 	fibProtector. unlock ();
 }
 
+//
+//	The queries are answered from the snapshot published by the
+//	fibProcessor, so there is no need to wait for the FIB processing
 uint8_t	ficHandler::kindofService	(std::string &s) {
-uint8_t	result;
-	fibProtector. lock ();
-	result	= fibProcessor. kindofService (s);
-	fibProtector. unlock ();
-	return result;
+	return fibProcessor. kindofService (s);
 }
 
 void	ficHandler::dataforAudioService	(std::string &s, audiodata *d, int c) {
-	fibProtector. lock ();
 	fibProcessor. dataforAudioService (s, d, c);
-	fibProtector. unlock ();
 }
 
 void	ficHandler::dataforDataService	(std::string &s, packetdata *d, int c) {
-	fibProtector. lock ();
 	fibProcessor. dataforDataService (s, d, c);
-	fibProtector. unlock ();
+}
+
+void	ficHandler::get_serviceList	(std::vector<serviceDescriptor> &l) {
+	fibProcessor. get_serviceList (l);
+}
+
+int32_t	ficHandler::enumerate	(ensembleComponent_t h, void *ctx) {
+	return fibProcessor. enumerate (h, ctx);
+}
+//
+//	the warm start cache, the fibProcessor takes care of its own locking
+void	ficHandler::preload	(std::shared_ptr<const ensembleDB> cached) {
+	fibProcessor. preload (cached);
+}
+
+std::shared_ptr<const ensembleDB>
+	ficHandler::ensembleToSave	(void) {
+	return fibProcessor. ensembleToSave ();
+}
+
+bool	ficHandler::cacheIsStale	(void) {
+	return fibProcessor. cacheIsStale ();
 }
 
 int32_t ficHandler::get_CIFcount        (void) const {
@@ -242,12 +263,7 @@ bool    ficHandler::has_CIFcount        (void) const {
 
 std::complex<float>	ficHandler::get_coordinates (int16_t mainId,
                                              int16_t subId, bool *success) {
-std::complex<float> result;
-
-        fibProtector. lock ();
-        result = fibProcessor. get_coordinates (mainId, subId, success);
-        fibProtector. unlock ();
-        return result;
+        return fibProcessor. get_coordinates (mainId, subId, success);
 }
 //
 //	Alternative function (extended), contributed by Hayati Ayguen
@@ -259,13 +275,8 @@ std::complex<float>
 	                                 int16_t subId, bool *success,
 	                                 int16_t *pMainId, int16_t *pSubId,
 	                                 int16_t *pTD) {
-std::complex<float> result;
-
-        fibProtector. lock ();
-        result = fibProcessor. get_coordinates (mainId, subId, success,
-	                                        pMainId, pSubId, pTD);
-        fibProtector. unlock ();
-        return result;
+        return fibProcessor. get_coordinates (mainId, subId, success,
+	                                      pMainId, pSubId, pTD);
 }
 
 uint8_t ficHandler::getECC	(bool *success) {
@@ -297,16 +308,19 @@ int32_t	ficHandler::SIdFor	(std::string &name) {
 	return fibProcessor. SIdFor (name);
 }
 
-static	int 	pos	= 0;
-static	int	amount = 0;
+uint32_t ficHandler::get_changeCount	(void) const {
+//	no lock, because using std::atomic<> in fib_processor class
+	return fibProcessor. get_changeCount ();
+}
+
 void	ficHandler::show_ficCRC (bool b) {
 	if (b) 
-	   pos ++;
-	if (++amount >= 100) {
+	   ficCRC_ok ++;
+	if (++ficCRC_count >= 100) {
 	   if (fib_qualityHandler != nullptr)
-	      fib_qualityHandler (pos, userData);
-	   pos	= 0;
-	   amount	= 0;
+	      fib_qualityHandler (ficCRC_ok, userData);
+	   ficCRC_ok	= 0;
+	   ficCRC_count	= 0;
 	}
 }
 
@@ -47,6 +47,7 @@
 	this	-> T_g			= T_s - T_u;
 	fft_buffer			= my_fftHandler. getVector ();
 	phaseReference. resize (T_u);
+	conjVector. resize (T_u);
 	cnt				= 0;
 }
 
@@ -69,7 +70,6 @@ void	ofdmDecoder::processBlock_0 (std::complex<float> *buffer) {
 void	ofdmDecoder::decode (std::complex<float> *buffer,
 	                             int32_t blkno, int16_t *ibits) {
 int16_t	i;
-std::complex<float> conjVector [T_u];
 
       memcpy (fft_buffer, &(buffer[T_g]),
                                        T_u * sizeof (std::complex<float>));
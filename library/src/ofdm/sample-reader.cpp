@@ -54,6 +54,7 @@ int	i;
 
 	corrector	= 0;
 	running. store (true);
+	retuning. store (false);
 }
 
 	sampleReader::~sampleReader (void) {
@@ -72,6 +73,10 @@ void	sampleReader::setRunning (bool b) {
 	running. store (b);
 }
 
+void	sampleReader::setRetune	(bool b) {
+	retuning. store (b);
+}
+
 float	sampleReader::get_sLevel (void) {
 	return sLevel;
 }
@@ -82,11 +87,14 @@ std::complex<float> temp;
 	if (!running. load ())
 	   throw 21;
 
-	while (running. load () && (theRig -> Samples () < 1))
+	while (running. load () && !retuning. load () &&
+	                          (theRig -> Samples () < 1))
 	      usleep (100);
 
 	if (!running. load ())	
 	   throw 20;
+	if (retuning. load ())
+	   throw 22;
 //
 //	so here, bufferContent > 0
 	theRig -> getSamples (&temp, 1);
@@ -118,11 +126,14 @@ void	sampleReader::getSamples (std::complex<float>  *v,
 	                          int32_t n, int32_t phaseOffset) {
 int32_t		i;
 
-	while (running. load () && (theRig -> Samples () < n))
+	while (running. load () && !retuning. load () &&
+	                          (theRig -> Samples () < n))
 	   usleep (100);
 
 	if (!running. load ())	
 	   throw 20;
+	if (retuning. load ())
+	   throw 22;
 //
 	n = theRig -> getSamples (v, n);
 
@@ -24,6 +24,8 @@
 
 #include <utility>
 #include <numeric>
+#include <algorithm>
+#include <functional>
 
 #include	<stdio.h>
 #include	<inttypes.h>
@@ -175,15 +177,29 @@ void	TII_Detector::reset (void) {
 
 //	To eliminate (reduce?) noise in the input signal, we might
 //	add a few spectra before computing (up to the user)
-void	TII_Detector::addBuffer (std::vector<std::complex<float>> v,
+//	v points to (at least) T_u samples of the null period
+//	The accumulation is done on the floats, in straight loops
+//	without calls, such that the compiler can vectorize them.
+//	Summing is the special case alpha = beta = 1
+void	TII_Detector::addBuffer (const std::complex<float> *v,
 	                         float alfa, int32_t cifCounter) {
 int	i;
+float	*const __restrict avg	= P_allAvg;
+float	*const __restrict acc	= reinterpret_cast<float *>(theBuffer. data ());
+const float *const __restrict f	= reinterpret_cast<const float *>(fft_buffer);
+float	alpha	= 1.0F;
+float	beta	= 1.0F;
 
+	(void)cifCounter;
 //	apply reset()
 	if (isFirstAdd) {
-	   for (i = 0; i < T_u; i ++)
-	      theBuffer [i] = std::complex<float> (0, 0);
-	   memset (&P_allAvg [0], 0, T_u * sizeof (float));
+	   memset (acc, 0, 2 * T_u * sizeof (float));
+	   memset (avg, 0, T_u * sizeof (float));
+	}
+	else
+	if (alfa >= 0.0F) {
+	   alpha	= alfa;
+	   beta		= 1.0F - alfa;
 	}
 
 //	windowing + FFT
@@ -191,28 +207,14 @@ int	i;
 	   fft_buffer [i] = cmul (v [i], window [i]);
 	my_fftHandler. do_FFT ();
 
-	for (int j = 0; j < T_u; ++j ) {
-	   P_tmpNorm [j] = std::norm (fft_buffer [j]);
-	}
+	for (i = 0; i < T_u; i ++)
+	   avg [i] = alpha * avg [i] +
+	             beta * (f [2 * i] * f [2 * i] + f [2 * i + 1] * f [2 * i + 1]);
+	for (i = 0; i < 2 * T_u; i ++)
+	   acc [i] = alpha * acc [i] + beta * f [i];
 
-	if (alfa < 0.0F || isFirstAdd) {
-	   for (int j = 0; j < T_u; j++) {
-	      P_allAvg  [j] += P_tmpNorm [j];
-	      theBuffer [j] += fft_buffer [j];
-	   }
-	   isFirstAdd = false;
-	   numUsedBuffers ++;
-	}
-	else {
-	   const float alpha	= alfa;
-	   const float beta	= 1.0F - alpha;
-	   for (int j = 0; j < T_u; j++) {
-	      P_allAvg [j] = alpha * P_allAvg [j] + beta * P_tmpNorm [j];
-	      theBuffer [j] = alpha * theBuffer [j] +
-	                      beta * fft_buffer [j];
-	   }
-	   numUsedBuffers ++;
-	}
+	isFirstAdd	= false;
+	numUsedBuffers ++;
 }
 
 void	TII_Detector::collapse (std::complex<float> *inVec, float *outVec) {
@@ -388,6 +390,7 @@ void	TII_Detector::processNULL_ex (int	*pNumOut,
 	                              float	*outNxtSNR) {
 float	Psub[NUM_GROUPS][NUM_SUBIDS];	// power per subID per group
 int	Csub[NUM_GROUPS][NUM_SUBIDS];	// subID in 0 .. 23 per group - when sorting powers Psub[][]
+std::pair<float, int> cand [NUM_SUBIDS];	// (power, carrier) for selection
 float	P_grpPairNoise[NUM_GROUPS];	// avg noise power per carrier-pair
 int	numSubIDsInGroup[NUM_GROUPS];	// counter for possible subIDs in group
 int	num_subIDs [NUM_SUBIDS];	// counter for possible subIDs over all groups
@@ -399,7 +402,7 @@ int		groupNo, i, j;
 
 //	sum 4 times repeated spectrum of 384 carriers into P_avg[]
 //	don't intermix with exponential averaging ..
-	static int modeOneCarrierFFTidx [5] = {
+	static const int modeOneCarrierFFTidx [5] = {
 	                           (-768 + 2048) % 2048,
 	                           (-384 + 2048) % 2048,
 	      // center carrier 0 unused!
@@ -426,23 +429,26 @@ int		groupNo, i, j;
 	    int		* C = &Csub [groupNo][0];
 	    // sum power for possible carrier pairs per group
 	    for ( i = 0; i < NUM_SUBIDS; ++i ) {
-	        P [i] = P_avg [grpCarrierOff + 2 * i] +
-	                      P_avg [grpCarrierOff + 2 * i + 1];
-	        C [i] = grpCarrierOff + 2 * i;
+	        cand [i]. first	= P_avg [grpCarrierOff + 2 * i] +
+	                          P_avg [grpCarrierOff + 2 * i + 1];
+	        cand [i]. second = grpCarrierOff + 2 * i;
 	    }
 
-//	bubble sort NUM_MINS_FOR_NOISE smallest elements to the end
-//	using bubble sort cause we don't want to sort all
-	   for (j = 0; j < NUM_MINS_FOR_NOISE; j++) {
-	        for (i = 0; i < NUM_SUBIDS - 2 - j; i++) {
-	            if (P [i] < P [i + 1]) {
-	                std::swap (P [i], P [i + 1]);
-	                std::swap (C [i], C [i + 1]);
-	            }
-	        }
-	    }
+//	select the NUM_MINS_FOR_NOISE smallest elements to the end,
+//	then the MAX_NUM_TII biggest ones - in order - to the begin,
+//	we don't want to sort all
+	   std::nth_element (cand, cand + NUM_SUBIDS - NUM_MINS_FOR_NOISE,
+	                     cand + NUM_SUBIDS,
+	                     std::greater<std::pair<float, int>> ());
+	   std::partial_sort (cand, cand + MAX_NUM_TII,
+	                      cand + NUM_SUBIDS - NUM_MINS_FOR_NOISE,
+	                      std::greater<std::pair<float, int>> ());
+	   for (i = 0; i < NUM_SUBIDS; i ++) {
+	      P [i]	= cand [i]. first;
+	      C [i]	= cand [i]. second;
+	   }
 
-//	avg noise power per carrier-pair - of sorted 4 least powers
+//	avg noise power per carrier-pair - of the 4 least powers
 	   P_grpPairNoise [groupNo] =
 	          std::accumulate (P + (NUM_SUBIDS -NUM_MINS_FOR_NOISE),
 	                           P + NUM_SUBIDS, 0.0F ) / NUM_MINS_FOR_NOISE;
@@ -450,16 +456,8 @@ int		groupNo, i, j;
 //	init counter for possible subIDs in group
 	   numSubIDsInGroup[groupNo] = 0;
 
-//	bubble sort MAX_NUM_TII biggest elements to the begin
+//	the MAX_NUM_TII biggest elements are at the begin
 	   for (j = 0; j < MAX_NUM_TII; j++) {
-//	array size is 20, cause lowest 4 elements are
-//	already at the tail (of 24 elements)
-	      for (i = NUM_SUBIDS - NUM_MINS_FOR_NOISE - 2; i >= j; --i) {
-	         if (P [i + 1] > P [i]) {
-	            std::swap (P [i], P [i + 1]);
-	            std::swap (C [i], C [i + 1]);
-	         }
-	      }
 	      if ((P [j] <  MIN_SNR_POWER_RATIO * P_grpPairNoise [groupNo])
 	          || (P_avg [C [j]] < (MIN_SNR_POWER_RATIO / 2.0F) * P_grpPairNoise[groupNo] )
 	          || (P_avg [C [j] + 1] < (MIN_SNR_POWER_RATIO / 2.0F) * P_grpPairNoise[groupNo] ))
@@ -501,29 +499,32 @@ int		groupNo, i, j;
 	   float sumPnoise	= 0.0F;
 	   float maxPnoise	= -1.0F;
 	   float minGrpSNR	= - MIN_SNR;
-//	bubble sort 4 + 1 maxima to begin
-	   for (j = 0; j <= NUM_SUBIDS_IN_PATTERN; j++) {
-	      for (i = numGroupsWithSubID - 2; i >= j; i--) {
-	         if (subP [i + 1] > subP [i]) {
-	            std::swap (subP [i], subP [i + 1]);
-	            std::swap (subGrpNo [i], subGrpNo [i + 1]);
-	         }
-	      }
-
-	      if (j < NUM_SUBIDS_IN_PATTERN) {
-	         groupNo = subGrpNo [j];
-	         groupPatternBits |= ( 1 << ( NUM_GROUPS -1 - groupNo));
-	         sumPsig	+= subP [j];
-	         sumPnoise	+= P_grpPairNoise [groupNo];
-	         if (P_grpPairNoise [groupNo] > maxPnoise)
-	            maxPnoise = P_grpPairNoise [groupNo];
+//	select the 4 + 1 maxima - in order - to the begin
+	   const int numMax	= std::min (NUM_SUBIDS_IN_PATTERN + 1,
+	                                    numGroupsWithSubID);
+	   for (i = 0; i < numGroupsWithSubID; i ++) {
+	      cand [i]. first	= subP [i];
+	      cand [i]. second	= subGrpNo [i];
+	   }
+	   std::partial_sort (cand, cand + numMax, cand + numGroupsWithSubID,
+	                      std::greater<std::pair<float, int>> ());
+	   for (i = 0; i < numGroupsWithSubID; i ++) {
+	      subP [i]		= cand [i]. first;
+	      subGrpNo [i]	= cand [i]. second;
+	   }
+	   for (j = 0; j < NUM_SUBIDS_IN_PATTERN; j++) {
+	      groupNo = subGrpNo [j];
+	      groupPatternBits |= ( 1 << ( NUM_GROUPS -1 - groupNo));
+	      sumPsig	+= subP [j];
+	      sumPnoise	+= P_grpPairNoise [groupNo];
+	      if (P_grpPairNoise [groupNo] > maxPnoise)
+	         maxPnoise = P_grpPairNoise [groupNo];
 #if 1
-	         float grpSNR =
-	                 powerRatio (subP [j], P_grpPairNoise [groupNo]);
-	         if ((grpSNR < minGrpSNR) || (minGrpSNR < 0.0F))
-	            minGrpSNR = grpSNR;
+	      float grpSNR =
+	              powerRatio (subP [j], P_grpPairNoise [groupNo]);
+	      if ((grpSNR < minGrpSNR) || (minGrpSNR < 0.0F))
+	         minGrpSNR = grpSNR;
 #endif
-	      }
 	   }
 
 	   const float minPsig = subP [NUM_SUBIDS_IN_PATTERN - 1];
@@ -0,0 +1,154 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+
+#include	"tii_processor.h"
+
+	tiiProcessor::tiiProcessor (uint8_t dabMode, void *userData):
+	                                theDetector (dabMode),
+	                                nullPeriods (TII_QUEUE_SIZE *
+	                                     dabParams (dabMode). get_T_u ()) {
+	this	-> T_u		= dabParams (dabMode). get_T_u ();
+	this	-> userData	= userData;
+	tiiHandler		= nullptr;
+	tiiExHandler		= nullptr;
+	framedelay		= 20;
+	alfa			= -1.0F;
+	resetFrameCount		= -1;
+	counter			= 0;
+	resetRequest. store (false);
+	active. store (false);
+	running. store (false);
+}
+
+	tiiProcessor::~tiiProcessor (void) {
+	if (running. load ()) {
+	   running. store (false);
+	   threadHandle. join ();
+	}
+}
+//
+//	the thread is started with the first handler set
+void	tiiProcessor::setHandlers (tii_t tii_Handler,
+	                           tii_ex_t tii_ExHandler,
+	                           int framedelay,
+	                           float alfa, int resetFrameCount) {
+	locker. lock ();
+	if (framedelay > 0)
+	   this -> framedelay	= framedelay;
+	tiiHandler		= tii_Handler;
+	tiiExHandler		= tii_ExHandler;
+	this	-> alfa		= alfa;
+	this	-> resetFrameCount	= resetFrameCount;
+	active. store ((tiiHandler != nullptr) || (tiiExHandler != nullptr));
+	locker. unlock ();
+	if (active. load () && !running. load ()) {
+	   running. store (true);
+	   threadHandle	= std::thread (&tiiProcessor::run, this);
+	}
+}
+
+bool	tiiProcessor::isActive	(void) {
+	return active. load ();
+}
+//
+//	called by the thread processing the samples, it never waits
+void	tiiProcessor::addBuffer	(const std::complex<float> *v) {
+	if (!running. load ())
+	   return;
+	if (nullPeriods. GetRingBufferWriteAvailable () < T_u)
+	   return;		// tii thread is behind, skip this one
+	nullPeriods. putDataIntoBuffer (v, T_u);
+	usedSlots. Release ();
+}
+//
+//	on loss of sync, the averages are to be restarted. The null
+//	periods still queued are from before, they are skipped
+void	tiiProcessor::reset	(void) {
+	resetRequest. store (true);
+}
+
+void	tiiProcessor::run	(void) {
+std::vector<std::complex<float>> buffer (T_u);
+tii_t		handler;
+tii_ex_t	exHandler;
+float		alfa;
+int		framedelay, resetFrameCount;
+int16_t	mainId, subId;
+int	numOut;
+int	outTii [24];
+float	outAvgSNR [24];
+float	outMinSNR [24];
+float	outNxtSNR [24];
+
+	while (running. load ()) {
+	   if (!usedSlots. tryAcquire (200))
+	      continue;
+	   if (resetRequest. exchange (false)) {
+	      theDetector. reset ();
+	      counter	= 0;
+	      while (nullPeriods. GetRingBufferReadAvailable () >= T_u) {
+	         nullPeriods. getDataFromBuffer (buffer. data (), T_u);
+	         usedSlots. tryAcquire (0);
+	      }
+	      continue;
+	   }
+	   if (nullPeriods. GetRingBufferReadAvailable () < T_u)
+	      continue;
+	   nullPeriods. getDataFromBuffer (buffer. data (), T_u);
+//
+//	the handlers are called without holding the lock
+	   locker. lock ();
+	   handler		= tiiHandler;
+	   exHandler		= tiiExHandler;
+	   alfa			= this -> alfa;
+	   framedelay		= this -> framedelay;
+	   resetFrameCount	= this -> resetFrameCount;
+	   locker. unlock ();
+
+	   theDetector. addBuffer (buffer. data (), alfa);
+	   if (++ counter >= framedelay) {
+	      counter	= 0;
+	      if (handler != nullptr) {
+	         theDetector. processNULL (&mainId, &subId);
+	         handler (mainId, subId,
+	                  theDetector. getNumBuffers (), userData);
+	      }
+	      else
+	      if (exHandler != nullptr) {
+	         theDetector. processNULL_ex (&numOut, outTii,
+	                                      outAvgSNR, outMinSNR, outNxtSNR);
+	         if (numOut > 0)
+	            exHandler (numOut, outTii,
+	                       outAvgSNR, outMinSNR, outNxtSNR,
+	                       theDetector. getNumBuffers (),
+	                       theDetector. P_allAvg,
+	                       (int)T_u, userData);
+	      }
+	   }
+	   if ((resetFrameCount > 0) &&
+	       (theDetector. getNumBuffers () >= resetFrameCount))
+	      theDetector. reset ();
+	}
+}
+
@@ -0,0 +1,113 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include	"crc-handler.h"
+
+#define	CRC_POLY	0x1021
+//
+//	crcTables [0][n] is the register contents after shifting the
+//	byte n through the (empty) register, crcTables [k][n] is the
+//	same, followed by k zero bytes. With these 8 tables 8 bytes
+//	can be handled with 8 lookups and no data dependent branches.
+//	The tables are built once, at load time, and are read-only
+//	afterwards, so the functions here can be called from any thread.
+class	crcTables {
+public:
+	uint16_t	T [8][256];
+		crcTables (void) {
+	for (int n = 0; n < 256; n ++) {
+	   uint16_t reg	= n << 8;
+	   for (int j = 0; j < 8; j ++)
+	      reg = (reg & 0x8000) ? (reg << 1) ^ CRC_POLY : reg << 1;
+	   T [0][n]	= reg;
+	}
+	for (int k = 1; k < 8; k ++)
+	   for (int n = 0; n < 256; n ++)
+	      T [k][n] = (T [k - 1][n] << 8) ^ T [0][T [k - 1][n] >> 8];
+	}
+};
+
+static	const crcTables theTables;
+
+uint16_t	crc16_bytes (const uint8_t *msg, int32_t len, uint16_t init) {
+const uint16_t	(*T)[256]	= theTables. T;
+uint16_t	crc	= init;
+
+	while (len >= 8) {
+	   crc	= T [7][msg [0] ^ (crc >> 8)] ^
+	          T [6][msg [1] ^ (crc & 0xFF)] ^
+	          T [5][msg [2]] ^ T [4][msg [3]] ^
+	          T [3][msg [4]] ^ T [2][msg [5]] ^
+	          T [1][msg [6]] ^ T [0][msg [7]];
+	   msg	+= 8;
+	   len	-= 8;
+	}
+
+	while (len -- > 0)
+	   crc	= (crc << 8) ^ T [0][(crc >> 8) ^ *msg ++];
+	return crc;
+}
+
+bool	check_crc16_bytes (const uint8_t *msg, int32_t len) {
+uint16_t	crc	= crc16_bytes (msg, len) ^ 0xFFFF;
+
+	return crc == ((msg [len] << 8) | msg [len + 1]);
+}
+//
+//	The bits are packed into bytes, a small stack buffer is used
+//	per 64 bytes, such that the table driven code can do the work.
+//	Trailing bits - if the number of payload bits is not a multiple
+//	of 8 - are handled one at a time.
+bool	check_crc16_bits (const uint8_t *in, int32_t size) {
+uint8_t		buffer [64];
+int32_t		nBits	= size - 16;
+int32_t		nBytes	= nBits / 8;
+uint16_t	crc	= 0xFFFF;
+uint16_t	received	= 0;
+
+	if (nBits < 0)
+	   return false;
+
+	while (nBytes > 0) {
+	   int32_t chunk = nBytes < 64 ? nBytes : 64;
+	   for (int32_t i = 0; i < chunk; i ++) {
+	      uint8_t	v	= 0;
+	      for (int j = 0; j < 8; j ++)
+	         v = (v << 1) | (in [j] & 01);
+	      buffer [i]	= v;
+	      in	+= 8;
+	   }
+	   crc		= crc16_bytes (buffer, chunk, crc);
+	   nBytes	-= chunk;
+	}
+
+	for (int32_t i = 0; i < (nBits & 07); i ++) {
+	   bool bit	= ((crc >> 15) ^ *in ++) & 01;
+	   crc		= bit ? (crc << 1) ^ CRC_POLY : crc << 1;
+	}
+
+	for (int i = 0; i < 16; i ++)
+	   received = (received << 1) | (in [i] & 01);
+	return (crc ^ 0xFFFF) == received;
+}
+
@@ -144,7 +144,7 @@ int8_t  *PI1, *PI2, *PI_X;
 	eep_protection::~eep_protection (void) {
 }
 
-bool	eep_protection::deconvolve (int16_t *v,
+bool	eep_protection::deconvolve (int8_t *v,
 	                            int32_t size, uint8_t *outBuffer) {
 
 int16_t	i;
@@ -152,7 +152,7 @@ int16_t	inputCounter	= 0;
 
 	(void)size;			// currently unused
 	memset (viterbiBlock. data (), 0,
-	                 (outSize * 4 + 24) * sizeof (int16_t)); 
+	                 (outSize * 4 + 24) * sizeof (int8_t)); 
 
 	for (i = 0; i < outSize * 4 + 24; i ++)
            if (indexTable [i])
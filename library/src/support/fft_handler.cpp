@@ -22,6 +22,33 @@
  */
 #include	"fft_handler.h"
 #include	<cstring>
+#include	<mutex>
+#include	<map>
+//
+//	The plans are shared by all handlers of the same size, in
+//	all dabProcessor instances of the process. Executing a plan
+//	(with fftwf_execute_dft on the array of the handler) is thread
+//	safe, the fftw planner is not, so creating plans is serialized.
+//	The plans - one per dab mode at most - live until exit
+static	std::mutex			planLocker;
+static	std::map<int32_t, fftwf_plan>	sharedPlans;
+
+static
+fftwf_plan	getPlan		(int32_t fftSize) {
+fftwf_plan	plan;
+
+	planLocker. lock ();
+	if (sharedPlans. count (fftSize) == 0) {
+	   fftwf_complex *v = (fftwf_complex *)
+	                   fftwf_malloc (sizeof (fftwf_complex) * fftSize);
+	   sharedPlans [fftSize] = fftwf_plan_dft_1d (fftSize, v, v,
+	                                         FFTW_FORWARD, FFTW_ESTIMATE);
+	   fftwf_free (v);
+	}
+	plan	= sharedPlans [fftSize];
+	planLocker. unlock ();
+	return plan;
+}
 
 	fft_handler::fft_handler (uint8_t dabMode): p (dabMode) {
 	int i;
@@ -30,14 +57,10 @@
 	                fftwf_malloc (sizeof (complex<float>) * fftSize);
 	for (i = 0; i < fftSize; i ++)
 	   vector [i] = std::complex<float> (0, 0);
-	plan	= fftwf_plan_dft_1d (fftSize,
-	                            reinterpret_cast <fftwf_complex *>(vector),
-	                            reinterpret_cast <fftwf_complex *>(vector),
-	                            FFTW_FORWARD, FFTW_ESTIMATE);
+	plan	= getPlan (fftSize);
 }
 
 	fft_handler::~fft_handler (void) {
-	   fftwf_destroy_plan (plan);
 	   fftwf_free (vector);
 }
 
@@ -46,7 +69,9 @@ complex<float>	*fft_handler::getVector () {
 }
 //
 void	fft_handler::do_FFT (void) {
-	fftwf_execute (plan);
+	fftwf_execute_dft (plan,
+	                   reinterpret_cast <fftwf_complex *>(vector),
+	                   reinterpret_cast <fftwf_complex *>(vector));
 }
 
 //	Note that we do not scale in case of backwards fft,
@@ -55,7 +80,7 @@ void	fft_handler::do_iFFT (void) {
 int	i;
 	for (i = 0; i < fftSize; i ++)
 	   vector [i] = conj (vector [i]);
-	fftwf_execute (plan);
+	do_FFT ();
 	for (i = 0; i < fftSize; i ++)
 	   vector [i] = conj (vector [i]);
 }
@@ -33,7 +33,7 @@
 }
 
         protection::~protection (void) {}
-bool    protection::deconvolve  (int16_t *a, int32_t b, uint8_t *c) {
+bool    protection::deconvolve  (int8_t *a, int32_t b, uint8_t *c) {
            (void)a; (void)b; (void)c;
            return false;
 }
@@ -43,26 +43,31 @@ void	tii_table::cleanUp (void) {
 	mainId		= -1;
 }
 
-void	tii_table::add_main	(int16_t mainId, float latitude, float longitude) {
+bool	tii_table::add_main	(int16_t mainId, float latitude, float longitude) {
 	if (this -> mainId > 0)
-	   return;
+	   return false;
+	if ((this -> mainId == mainId) &&
+	    (this -> latitude == latitude) && (this -> longitude == longitude))
+	   return false;
 	this	-> mainId = mainId;
 	this	-> latitude	= latitude;
 	this	-> longitude	= longitude;
+	return true;
 }
 
-void	tii_table::add_element (tii_element *t) {
+bool	tii_table::add_element (tii_element *t) {
 uint16_t i;
 
 	for (i = 0; i < offsets. size (); i ++)
 	   if (offsets [i]. subId == t -> subId)
-	      return;
+	      return false;
 
 	offsets. push_back (*t);
+	return true;
 }
 
 std::complex<float> tii_table::get_coordinates (int16_t mainId,
-	                               int16_t subId, bool *success) {
+	                               int16_t subId, bool *success) const {
 uint16_t i;
 float x, y;
 
@@ -92,7 +97,7 @@ std::complex<float>
 	tii_table::get_coordinates (int16_t mainId, int16_t subId,
 	                            bool *success,
 	                            int16_t *pMainId, int16_t *pSubId,
-	                            int16_t *pTD) {
+	                            int16_t *pTD) const {
 uint16_t i;
 float x, y;
 
@@ -127,7 +132,7 @@ float x, y;
 	return std::complex<float> (0, 0);
 }
 
-void	tii_table::print_coordinates	(void) {
+void	tii_table::print_coordinates	(void) const {
 uint16_t	i;
 	if (mainId < 0)
 	   return;
@@ -228,14 +228,14 @@ int8_t          *PI_X;
 	uep_protection::~uep_protection (void) {
 }
 
-bool	uep_protection::deconvolve (int16_t *v,
+bool	uep_protection::deconvolve (int8_t *v,
 	                            int32_t size, uint8_t *outBuffer) {
 int16_t	i;
 int16_t	inputCounter	= 0;
 
 	(void)size;			// currently unused
 	memset (viterbiBlock. data (), 0,
-	                        (outSize * 4 + 24) * sizeof (int16_t)); 
+	                        (outSize * 4 + 24) * sizeof (int8_t)); 
 
 
         for (i = 0; i < outSize * 4 + 24; i ++)
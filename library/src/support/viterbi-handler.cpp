@@ -31,10 +31,6 @@
 #define	Poly4 	0133
 #define	numofStates	(1 << (K - 1))
 
-static	int	predecessor_for_0 [numofStates];
-static	int	predecessor_for_1 [numofStates];
-static	int16_t	indexTable [2 * numofStates];
-
 	viterbiHandler::viterbiHandler (int blockLength) {
 int	i, j;
 	this	-> blockLength	= blockLength;
@@ -124,7 +120,20 @@ void	viterbiHandler::computeCostTable (int16_t sym_0,
 
 //      block is the sequence of soft bits
 //      its length = 4 * blockLength + 4 * 6
+//	The FIC soft bits are int16_t (-1024 .. 1024), the MSC soft bits
+//	are int8_t (-127 .. 127, -128 is never produced, so negating
+//	is safe). The costs are computed in int, whatever the input type
 void	viterbiHandler::deconvolve	(int16_t *sym, uint8_t *bitBuffer) {
+	decodeBlock (sym, bitBuffer);
+}
+
+void	viterbiHandler::deconvolve	(int8_t *sym, uint8_t *bitBuffer) {
+	decodeBlock (sym, bitBuffer);
+}
+
+template <typename softBit>
+void	viterbiHandler::decodeBlock	(const softBit *sym,
+	                                 uint8_t *bitBuffer) {
 int	prev_0, prev_1;
 int	costs_0, costs_1;
 int	i;
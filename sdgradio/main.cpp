@@ -377,6 +377,12 @@ static void bytesOut_Handler(uint8_t *data, int16_t amount, uint8_t type,
 //	audiohandler, based on portaudio. Feel free to modify this
 //	and send the samples elsewhere
 //
+#ifdef  AAC_OUT
+#define AUDIO_FORMAT    AUDIO_OUT_LATM
+#else
+#define AUDIO_FORMAT    AUDIO_OUT_PCM
+#endif
+
 static void pcmHandler(int16_t *buffer, int size, int rate, bool isStereo,
                        void *ctx)
 {
@@ -666,7 +672,7 @@ int main(int argc, char **argv)
     }
 
     dabReset_msc(theRadio);
-    set_audioChannel (theRadio, &ad);
+    set_audioChannel_ex(theRadio, &ad, AUDIO_FORMAT);
 
     while (run.load())
         sleep(1);
@@ -747,7 +753,7 @@ void selectNext(void)
     }
 
     dabReset_msc(theRadio);
-    set_audioChannel(theRadio, &ad);
+    set_audioChannel_ex(theRadio, &ad, AUDIO_FORMAT);
 
     fprintf(stderr, "{\"ps\":\"%s\"}\n", programName.c_str());
 }
@@ -784,7 +790,7 @@ void listener(void)
             fprintf(stderr, "{\"ps\":\"%s\"}\n", programName.c_str());
 
             dabReset_msc(theRadio);
-            set_audioChannel(theRadio, &ad);
+            set_audioChannel_ex(theRadio, &ad, AUDIO_FORMAT);
         }
     }
 }
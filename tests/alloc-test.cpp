@@ -0,0 +1,344 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+//
+//	Counts the heap allocations of the steady state paths:
+//	ficHandler::process_ficBlock (with a valid, repeating FIC),
+//	dataProcessor::addtoFrame (packets assembled into datagroups)
+//	and - when fftw is available - ofdmDecoder::decode.
+//	After a warm-up, none of them should allocate.
+//	operator new is replaced here, malloc, calloc and realloc of the
+//	library sources are wrapped by the linker (--wrap)
+#include	<assert.h>
+#include	<atomic>
+#include	<new>
+#include	<vector>
+#include	"dab-constants.h"
+#include	"fic-handler.h"
+#include	"protTables.h"
+#include	"crc-handler.h"
+#include	"data-processor.h"
+#include	"ip-sink.h"
+#ifdef	HAVE_FFTW
+#include	"ofdm-decoder.h"
+#endif
+
+static	std::atomic<int64_t>	allocations (0);
+
+extern "C" {
+void	*__real_malloc	(size_t);
+void	*__real_calloc	(size_t, size_t);
+void	*__real_realloc	(void *, size_t);
+
+void	*__wrap_malloc	(size_t n) {
+	allocations ++;
+	return __real_malloc (n);
+}
+
+void	*__wrap_calloc	(size_t n, size_t s) {
+	allocations ++;
+	return __real_calloc (n, s);
+}
+
+void	*__wrap_realloc	(void *p, size_t n) {
+	allocations ++;
+	return __real_realloc (p, n);
+}
+}
+
+void	*operator new	(size_t n) {
+	allocations ++;
+	void *p	= __real_malloc (n == 0 ? 1 : n);
+	if (p == nullptr)
+	   throw std::bad_alloc ();
+	return p;
+}
+
+void	*operator new []	(size_t n) {
+	return operator new (n);
+}
+
+void	operator delete	(void *p) noexcept {
+	free (p);
+}
+
+void	operator delete []	(void *p) noexcept {
+	free (p);
+}
+
+#define	WARMUP_FRAMES	5
+#define	FRAMES		50
+
+static
+void	toBits	(const uint8_t *bytes, int n, uint8_t *bits) {
+	for (int i = 0; i < n; i ++)
+	   for (int j = 0; j < 8; j ++)
+	      bits [8 * i + j] = (bytes [i] >> (7 - j)) & 01;
+}
+//
+//	bytes [0 .. n - 3] is the message, the crc is put in the last two
+static
+void	addCRC	(uint8_t *bytes, int n) {
+uint16_t crc	= ~crc16_bytes (bytes, n - 2);
+	bytes [n - 2]	= crc >> 8;
+	bytes [n - 1]	= crc & 0xFF;
+}
+
+//////////////////////////////////////////////////////////////////////
+//	The FIC: 3 FIBs per codeword, 4 codewords per (mode 1) frame
+//
+static
+void	putLabel	(uint8_t *d, const char *s) {
+	memset (d, ' ', 16);
+	memcpy (d, s, strlen (s));
+	d [16]	= 0xFF;			// character flags
+	d [17]	= 0x00;
+}
+//
+//	FIB 0: FIG0/0 (with the CIF count) and the ensemble label,
+//	FIB 1: FIG0/1 and FIG0/2 for one audio service,
+//	FIB 2: the service label
+static
+void	makeFIBs	(int cifCount, uint8_t fibs [3][32]) {
+uint8_t	*d;
+
+	memset (fibs, 0xFF, 3 * 32);	// end markers and padding
+	d	= fibs [0];
+	d [0]	= (0 << 5) | 5;		// FIG0, 5 bytes
+	d [1]	= 0;			// C/N, OE, P/D, extension 0
+	d [2]	= 0x40; d [3] = 0x01;	// EId
+	d [4]	= ((cifCount / 250) % 20) & 0x1F;
+	d [5]	= cifCount % 250;
+	d	= &fibs [0][6];
+	d [0]	= (1 << 5) | 21;	// FIG1, 21 bytes
+	d [1]	= 0;			// charset, OE, extension 0
+	d [2]	= 0x40; d [3] = 0x01;
+	putLabel (&d [4], "TEST ENSEMBLE");
+
+	d	= fibs [1];
+	d [0]	= (0 << 5) | 4;		// FIG0/1, one short form subchannel
+	d [1]	= 1;
+	d [2]	= (3 << 2) | 0;		// subchId 3, start address 0
+	d [3]	= 0;
+	d [4]	= 0x00 | 8;		// short form, table index 8
+	d	= &fibs [1][5];
+	d [0]	= (0 << 5) | 6;		// FIG0/2, one service
+	d [1]	= 2;
+	d [2]	= 0x40; d [3] = 0x11;	// SId
+	d [4]	= 1;			// one component
+	d [5]	= 63;			// TMId 0, ASCTy 63 (DAB+)
+	d [6]	= (3 << 2) | 02;	// subchId 3, primary
+
+	d	= fibs [2];
+	d [0]	= (1 << 5) | 21;	// FIG1/1, the service label
+	d [1]	= 1;
+	d [2]	= 0x40; d [3] = 0x11;
+	putLabel (&d [4], "TEST SERVICE");
+	for (int i = 0; i < 3; i ++)
+	   addCRC (fibs [i], 32);
+}
+//
+//	energy dispersal, convolutional coding and puncturing as in
+//	the standard, the inverse of ficHandler::process_ficInput
+static
+void	encodeFIC	(uint8_t fibs [3][32], int16_t *soft) {
+uint8_t	bits [768];
+uint8_t	shiftRegister [9];
+uint8_t	coded [4 * 768 + 24];
+const int polynomes [4] = {0133, 0171, 0145, 0133};
+int	state	= 0;
+int	n	= 0;
+int	local	= 0;
+
+	for (int i = 0; i < 3; i ++)
+	   toBits (fibs [i], 32, &bits [256 * i]);
+	memset (shiftRegister, 1, 9);
+	for (int i = 0; i < 768; i ++) {
+	   uint8_t prbs = shiftRegister [8] ^ shiftRegister [4];
+	   for (int j = 8; j > 0; j --)
+	      shiftRegister [j] = shiftRegister [j - 1];
+	   shiftRegister [0] = prbs;
+	   bits [i] ^= prbs;
+	}
+	for (int i = 0; i < 768 + 6; i ++) {
+	   int reg	= ((i < 768 ? bits [i] : 0) << 6) | state;
+	   for (int j = 0; j < 4; j ++) {
+	      int v = reg & polynomes [j], p = 0;
+	      while (v != 0) {
+	         p ^= v & 01;
+	         v >>= 1;
+	      }
+	      if (4 * i + j < 4 * 768 + 24)
+	         coded [4 * i + j] = p;
+	   }
+	   state	= reg >> 1;
+	}
+	for (int i = 0; i < 21 * 128; i ++, local ++)
+	   if (get_PCodes (16 - 1) [i % 32] == 1)
+	      soft [n ++] = coded [local] ? 1024 : -1024;
+	for (int i = 0; i < 3 * 128; i ++, local ++)
+	   if (get_PCodes (15 - 1) [i % 32] == 1)
+	      soft [n ++] = coded [local] ? 1024 : -1024;
+	for (int i = 0; i < 24; i ++, local ++)
+	   if (get_PCodes (8 - 1) [i] == 1)
+	      soft [n ++] = coded [local] ? 1024 : -1024;
+	assert (n == 2304);
+}
+
+static	int	fibCount	= 0;
+
+static
+void	fibQuality	(int16_t q, void *ctx) {
+	(void)q; (void)ctx;
+	fibCount ++;
+}
+
+static
+void	testFIC	(void) {
+ficHandler	theFic (1, nullptr, nullptr, fibQuality, nullptr);
+//	a mode 1 frame has 3 FIC blocks of 3072 soft bits,
+//	i.e. 4 codewords of 2304
+std::vector<int16_t>	frames ((WARMUP_FRAMES + FRAMES) * 3 * 3072);
+uint8_t	fibs [3][32];
+int64_t	before	= 0;
+
+	for (int f = 0; f < WARMUP_FRAMES + FRAMES; f ++)
+	   for (int c = 0; c < 4; c ++) {
+	      makeFIBs (4 * f + c, fibs);
+	      encodeFIC (fibs, &frames [(f * 4 + c) * 2304]);
+	   }
+
+	for (int f = 0; f < WARMUP_FRAMES + FRAMES; f ++) {
+	   if (f == WARMUP_FRAMES)
+	      before	= allocations. load ();
+	   for (int b = 1; b <= 3; b ++)
+	      theFic. process_ficBlock (&frames [(f * 3 + b - 1) * 3072], b);
+	}
+	int64_t n	= allocations. load () - before;
+	std::string name = theFic. nameFor (0x4011);
+	fprintf (stderr, "process_ficBlock: %lld allocations in %d frames\n",
+	                                     (long long)n, FRAMES);
+	assert (name. find ("TEST SERVICE") == 0);	// the FIC was decoded
+	assert (n == 0);
+}
+
+//////////////////////////////////////////////////////////////////////
+//	Packet data: 8 kbit/s gives one 24 byte packet per CIF, the
+//	datagroups are 3 packets (first, intermediate, last) long
+//
+#define	BIT_RATE	8
+
+static
+void	makePacket	(int address, int firstLast, int ci, uint8_t *bits) {
+uint8_t	p [24];
+
+	memset (p, 0, 24);
+	p [0]	= (0 << 6) | ((ci & 03) << 4) | (firstLast << 2) |
+	                                          ((address >> 8) & 03);
+	p [1]	= address & 0xFF;
+	p [2]	= 19;			// command 0, useful length
+	for (int i = 0; i < 19; i ++)
+	   p [3 + i] = rand () & 0xFF;
+	addCRC (p, 24);
+	toBits (p, 24, bits);
+}
+
+static
+void	testData	(void) {
+dataProcessor	theProcessor (BIT_RATE);
+ipSink		theIPSink;
+packetdata	pd;
+const int	firstLast [] = {02, 00, 01};
+std::vector<uint8_t> frames ((WARMUP_FRAMES + FRAMES) * 4 * 24 * BIT_RATE);
+int64_t	before	= 0;
+
+	memset (&pd, 0, sizeof (pd));
+	pd. packetAddress	= 100;
+	pd. DSCTy		= 0;		// no specific handler
+	theProcessor. addStream (&pd, nullptr, nullptr, nullptr,
+	                                        &theIPSink, nullptr);
+	pd. packetAddress	= 101;
+	pd. DSCTy		= 59;		// IP, no destination set
+	theProcessor. addStream (&pd, nullptr, nullptr, nullptr,
+	                                        &theIPSink, nullptr);
+//
+//	4 CIFs per frame, alternating between the two addresses
+	for (int i = 0; i < (WARMUP_FRAMES + FRAMES) * 4; i ++)
+	   makePacket (100 + (i / 3) % 2, firstLast [i % 3], i / 6,
+	                            &frames [i * 24 * BIT_RATE]);
+
+	for (int i = 0; i < (WARMUP_FRAMES + FRAMES) * 4; i ++) {
+	   if (i == WARMUP_FRAMES * 4)
+	      before	= allocations. load ();
+	   theProcessor. addtoFrame (&frames [i * 24 * BIT_RATE]);
+	}
+	int64_t n	= allocations. load () - before;
+	fprintf (stderr, "addtoFrame: %lld allocations in %d frames\n",
+	                                     (long long)n, FRAMES);
+	assert (n == 0);
+}
+
+#ifdef	HAVE_FFTW
+//////////////////////////////////////////////////////////////////////
+//	The ofdm decoder, on random samples, with the iq buffer
+static
+void	testOFDM	(void) {
+RingBuffer<std::complex<float>> iqBuffer (8192);
+ofdmDecoder	theDecoder (1, &iqBuffer);
+dabParams	params (1);
+std::vector<std::complex<float>> samples (params. get_T_s ());
+std::vector<int16_t> ibits (2 * params. get_carriers ());
+std::vector<std::complex<float>> drain (8192);
+int64_t	before	= 0;
+
+	for (auto &s : samples)
+	   s = std::complex<float> (rand () / (float)RAND_MAX - 0.5,
+	                            rand () / (float)RAND_MAX - 0.5);
+	for (int f = 0; f < WARMUP_FRAMES + FRAMES; f ++) {
+	   if (f == WARMUP_FRAMES)
+	      before	= allocations. load ();
+	   theDecoder. processBlock_0 (samples. data ());
+	   for (int b = 1; b < params. get_L (); b ++)
+	      theDecoder. decode (samples. data (), b, ibits. data ());
+	   iqBuffer. getDataFromBuffer (drain. data (), 8192);
+	}
+	int64_t n	= allocations. load () - before;
+	fprintf (stderr, "ofdmDecoder::decode: %lld allocations in %d frames\n",
+	                                     (long long)n, FRAMES);
+	assert (n == 0);
+}
+#endif
+
+int	main	(void) {
+	srand (1);
+	testFIC ();
+	testData ();
+#ifdef	HAVE_FFTW
+	testOFDM ();
+#else
+	fprintf (stderr, "no fftw, ofdmDecoder::decode is not tested\n");
+#endif
+	fprintf (stderr, "alloc-test passed\n");
+	return 0;
+}
+
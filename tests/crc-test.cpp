@@ -0,0 +1,128 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+//
+//	The table driven crc16 functions are checked against the
+//	bitwise check_CRC_bits from dab-constants.h, on random
+//	messages of the lengths used in DAB (FIB, packets, datagroups),
+//	with and without errors. The time taken by both is printed.
+#include	<assert.h>
+#include	<chrono>
+#include	<vector>
+#include	"dab-constants.h"
+#include	"crc-handler.h"
+
+static
+void	toBits	(const std::vector<uint8_t> &bytes,
+	                 std::vector<uint8_t> &bits) {
+	bits. resize (8 * bytes. size ());
+	for (uint32_t i = 0; i < bytes. size (); i ++)
+	   for (int j = 0; j < 8; j ++)
+	      bits [8 * i + j] = (bytes [i] >> (7 - j)) & 01;
+}
+//
+//	check_CRC_bits modifies its input, so it gets a copy
+static
+bool	bitwise	(const std::vector<uint8_t> &bits) {
+std::vector<uint8_t> copy	= bits;
+
+	return check_CRC_bits (copy. data (), copy. size ());
+}
+
+static
+void	makeMessage	(std::vector<uint8_t> &msg, int len) {
+uint16_t	crc;
+
+	msg. resize (len + 2);
+	for (int i = 0; i < len; i ++)
+	   msg [i] = rand () & 0xFF;
+	crc	= ~crc16_bytes (msg. data (), len);
+	msg [len]	= crc >> 8;
+	msg [len + 1]	= crc & 0xFF;
+}
+
+static
+void	crossCheck	(void) {
+const int lengths [] = {1, 7, 8, 9, 22, 30, 62, 94, 255, 1024};
+std::vector<uint8_t> msg;
+std::vector<uint8_t> bits;
+
+	for (int len : lengths) {
+	   for (int n = 0; n < 200; n ++) {
+	      makeMessage (msg, len);
+	      toBits (msg, bits);
+	      assert (check_crc16_bytes (msg. data (), len));
+	      assert (check_crc16_bits (bits. data (), bits. size ()));
+	      assert (bitwise (bits));
+//	a single bit error, anywhere
+	      int e	= rand () % bits. size ();
+	      bits [e] ^= 1;
+	      msg [e / 8] ^= 0x80 >> (e % 8);
+	      assert (!check_crc16_bytes (msg. data (), len));
+	      assert (!check_crc16_bits (bits. data (), bits. size ()));
+	      assert (!bitwise (bits));
+//	random garbage: both agree
+	      for (auto &b : bits)
+	         b = rand () & 01;
+	      assert (check_crc16_bits (bits. data (), bits. size ()) ==
+	                                                     bitwise (bits));
+	   }
+	}
+}
+//
+//	a FIB is 256 bits, a FIC block of a frame has 12 of them
+static
+void	benchmark	(void) {
+const int	rounds	= 100000;
+std::vector<uint8_t> msg;
+std::vector<uint8_t> bits;
+std::vector<uint8_t> copy;
+int	ok	= 0;
+
+	makeMessage (msg, 30);
+	toBits (msg, bits);
+	auto t0	= std::chrono::steady_clock::now ();
+	for (int i = 0; i < rounds; i ++)
+	   ok += check_crc16_bits (bits. data (), bits. size ());
+	auto t1	= std::chrono::steady_clock::now ();
+	for (int i = 0; i < rounds; i ++) {
+	   copy	= bits;
+	   ok += check_CRC_bits (copy. data (), copy. size ());
+	}
+	auto t2	= std::chrono::steady_clock::now ();
+	assert (ok == 2 * rounds);
+	fprintf (stderr, "FIB crc: table %.1f ns, bitwise %.1f ns\n",
+	         std::chrono::duration<double, std::nano> (t1 - t0). count () /
+	                                                        rounds,
+	         std::chrono::duration<double, std::nano> (t2 - t1). count () /
+	                                                        rounds);
+}
+
+int	main	(void) {
+	srand (1);
+	crossCheck ();
+	benchmark ();
+	fprintf (stderr, "crc-test passed\n");
+	return 0;
+}
+
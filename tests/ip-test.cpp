@@ -0,0 +1,254 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+//
+//	ip_dataHandler with an ipSink: datagroups carrying IP datagrams
+//	are handed to the handler, what comes out is read from a local
+//	UDP socket (the payloads) or from a socketpair that stands in
+//	for the tunnel (the complete packets).
+//	Checked are a valid datagram, with and without UDP checksum,
+//	and the ones to be dropped: bad datagroup crc, bad IP header
+//	checksum, bad UDP checksum and an IP payload too short for the
+//	UDP header
+#include	<assert.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	<poll.h>
+#include	<vector>
+#include	<sys/socket.h>
+#include	<netinet/in.h>
+#include	<arpa/inet.h>
+#include	"crc-handler.h"
+#include	"datagroup-pool.h"
+#include	"ip-datahandler.h"
+#include	"ip-sink.h"
+
+static
+uint16_t	checksum	(uint32_t sum, const uint8_t *p, int n) {
+	for (int i = 0; i + 1 < n; i += 2)
+	   sum += (p [i] << 8) | p [i + 1];
+	if (n & 01)
+	   sum += p [n - 1] << 8;
+	while (sum >> 16)
+	   sum = (sum & 0xFFFF) + (sum >> 16);
+	return ~sum & 0xFFFF;
+}
+//
+//	an IPv4 packet, 127.0.0.1 to 127.0.0.1, protocol "protocol",
+//	with "payload" as (UDP) payload
+static
+std::vector<uint8_t> makePacket	(int protocol, uint16_t port,
+	                         const std::vector<uint8_t> &payload,
+	                         bool udpChecksum) {
+int	udpSize	= 8 + payload. size ();
+std::vector<uint8_t> p (20 + udpSize);
+uint16_t sum;
+
+	p [0]	= 0x45;			// version 4, 5 words of header
+	p [2]	= p. size () >> 8;
+	p [3]	= p. size () & 0xFF;
+	p [8]	= 64;			// ttl
+	p [9]	= protocol;
+	p [12]	= 127; p [15] = 1;
+	p [16]	= 127; p [19] = 1;
+	sum	= checksum (0, p. data (), 20);
+	p [10]	= sum >> 8;
+	p [11]	= sum & 0xFF;
+
+	uint8_t *udp	= &p [20];
+	udp [0]	= 0x30; udp [1] = 0x39;	// source port 12345
+	udp [2]	= port >> 8;
+	udp [3]	= port & 0xFF;
+	udp [4]	= udpSize >> 8;
+	udp [5]	= udpSize & 0xFF;
+	memcpy (&udp [8], payload. data (), payload. size ());
+	if (udpChecksum) {
+	   sum	= checksum (checksum (17 + udpSize, &p [12], 8) ^ 0xFFFF,
+	                    udp, udpSize);
+	   udp [6]	= sum >> 8;
+	   udp [7]	= sum & 0xFF;
+	}
+	return p;
+}
+//
+//	the packet in a datagroup - 2 byte header, crc - one bit per byte,
+//	the way the dataProcessor delivers it
+static
+dataGroup	makeDatagroup	(dataGroupPool &pool,
+	                         const std::vector<uint8_t> &packet,
+	                         bool crcError) {
+std::vector<uint8_t> bytes;
+std::vector<uint8_t> bits;
+dataGroup	g	= pool. get ();
+uint16_t	crc;
+
+	bytes. push_back (0x40);		// crc flag
+	bytes. push_back (0x00);
+	bytes. insert (bytes. end (), packet. begin (), packet. end ());
+	crc	= ~crc16_bytes (bytes. data (), bytes. size ());
+	bytes. push_back (crc >> 8);
+	bytes. push_back (crc & 0xFF);
+	if (crcError)
+	   bytes [5] ^= 0x10;
+	for (uint8_t b : bytes)
+	   for (int j = 0; j < 8; j ++)
+	      bits. push_back ((b >> (7 - j)) & 01);
+	g. append (bits. data (), bits. size ());
+	return g;
+}
+//
+//	returns the size of the message read, -1 if there is none
+static
+int	receive	(int fd, uint8_t *buffer, int size) {
+struct pollfd	p;
+
+	p. fd		= fd;
+	p. events	= POLLIN;
+	if (poll (&p, 1, 200) != 1)
+	   return -1;
+	return recv (fd, buffer, size, 0);
+}
+
+static	std::vector<uint8_t> payload;
+
+static
+void	testSocket	(void) {
+dataGroupPool	pool;
+ipSink		theSink;
+ip_dataHandler	theHandler (&theSink);
+struct sockaddr_in	a;
+socklen_t	length	= sizeof (a);
+uint8_t		buffer [2048];
+int		receiver;
+uint16_t	port;
+
+	receiver	= socket (AF_INET, SOCK_DGRAM, 0);
+	assert (receiver >= 0);
+	memset (&a, 0, sizeof (a));
+	a. sin_family		= AF_INET;
+	a. sin_addr. s_addr	= htonl (INADDR_LOOPBACK);
+	assert (bind (receiver, (struct sockaddr *)&a, sizeof (a)) == 0);
+	assert (getsockname (receiver, (struct sockaddr *)&a, &length) == 0);
+	port	= ntohs (a. sin_port);
+//
+//	inactive sink: nothing is passed on
+	theHandler. add_mscDatagroup (makeDatagroup (pool,
+	                  makePacket (17, port, payload, true), false));
+	theHandler. flush ();
+	assert (receive (receiver, buffer, sizeof (buffer)) < 0);
+//
+//	port 0: the datagrams go to their own destination port
+	assert (theSink. setDestination ("127.0.0.1", 0));
+	assert (theSink. isActive ());
+	theHandler. add_mscDatagroup (makeDatagroup (pool,
+	                  makePacket (17, port, payload, true), false));
+	theHandler. add_mscDatagroup (makeDatagroup (pool,
+	                  makePacket (17, port, payload, false), false));
+	theHandler. flush ();
+	for (int i = 0; i < 2; i ++) {
+	   assert (receive (receiver, buffer, sizeof (buffer)) ==
+	                                        (int)payload. size ());
+	   assert (memcmp (buffer, payload. data (), payload. size ()) == 0);
+	}
+//
+//	bad datagroup crc
+	theHandler. add_mscDatagroup (makeDatagroup (pool,
+	                  makePacket (17, port, payload, true), true));
+//	bad IP header checksum
+	std::vector<uint8_t> p	= makePacket (17, port, payload, true);
+	p [11] ^= 0x01;
+	theHandler. add_mscDatagroup (makeDatagroup (pool, p, false));
+//	bad UDP checksum
+	p	= makePacket (17, port, payload, true);
+	p [20 + 7] ^= 0x01;
+	theHandler. add_mscDatagroup (makeDatagroup (pool, p, false));
+//	an IP payload of 4 bytes, too short for the UDP header
+	p	= makePacket (17, port, payload, false);
+	p. resize (24);
+	p [2]	= 0; p [3] = 24;
+	p [10]	= 0; p [11] = 0;
+	uint16_t sum	= checksum (0, p. data (), 20);
+	p [10]	= sum >> 8;
+	p [11]	= sum & 0xFF;
+	theHandler. add_mscDatagroup (makeDatagroup (pool, p, false));
+//	a UDP length larger than the IP packet
+	p	= makePacket (17, port, payload, false);
+	p [20 + 5] += 1;
+	theHandler. add_mscDatagroup (makeDatagroup (pool, p, false));
+//	not UDP, for a tunnel only
+	theHandler. add_mscDatagroup (makeDatagroup (pool,
+	                  makePacket (6, port, payload, false), false));
+	theHandler. flush ();
+	assert (receive (receiver, buffer, sizeof (buffer)) < 0);
+//
+//	and a valid one still gets through
+	theHandler. add_mscDatagroup (makeDatagroup (pool,
+	                  makePacket (17, port, payload, true), false));
+	theHandler. flush ();
+	assert (receive (receiver, buffer, sizeof (buffer)) ==
+	                                        (int)payload. size ());
+	close (receiver);
+	fprintf (stderr, "socket: ok\n");
+}
+//
+//	the tunnel gets the complete packets, UDP or not
+static
+void	testTunnel	(void) {
+dataGroupPool	pool;
+ipSink		theSink;
+ip_dataHandler	theHandler (&theSink);
+uint8_t		buffer [2048];
+int		fds [2];
+
+	assert (socketpair (AF_UNIX, SOCK_DGRAM, 0, fds) == 0);
+	theSink. setTunnel (fds [0]);
+	assert (theSink. isActive ());
+	std::vector<uint8_t> udp	= makePacket (17, 5000, payload, true);
+	std::vector<uint8_t> tcp	= makePacket (6, 5000, payload, false);
+	std::vector<uint8_t> bad	= udp;
+	bad [20 + 7] ^= 0x01;
+	theHandler. add_mscDatagroup (makeDatagroup (pool, udp, false));
+	theHandler. add_mscDatagroup (makeDatagroup (pool, bad, false));
+	theHandler. add_mscDatagroup (makeDatagroup (pool, tcp, false));
+	theHandler. flush ();
+	assert (receive (fds [1], buffer, sizeof (buffer)) == (int)udp. size ());
+	assert (memcmp (buffer, udp. data (), udp. size ()) == 0);
+	assert (receive (fds [1], buffer, sizeof (buffer)) == (int)tcp. size ());
+	assert (memcmp (buffer, tcp. data (), tcp. size ()) == 0);
+	assert (receive (fds [1], buffer, sizeof (buffer)) < 0);
+
+	theSink. setTunnel (-1);
+	assert (!theSink. isActive ());
+	close (fds [0]);
+	close (fds [1]);
+	fprintf (stderr, "tunnel: ok\n");
+}
+
+int	main	(void) {
+	for (int i = 0; i < 100; i ++)
+	   payload. push_back (i * 7 + 3);
+	testSocket ();
+	testTunnel ();
+	fprintf (stderr, "ip-test passed\n");
+	return 0;
+}
@@ -0,0 +1,159 @@
+#
+/*
+ *    Copyright (C) 2014 .. 2017
+ *    Jan van Katwijk (J.vanKatwijk@gmail.com)
+ *    Lazy Chair Computing
+ *
+ *    This file is part of the DAB library
+ *
+ *    DAB library is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    DAB library is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with DAB library; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#
+//
+//	The MSC soft bits are int8_t (softBit in dab-constants.h), they
+//	used to be int16_t, computed in the same way but not clamped.
+//	Random blocks are convolutionally encoded (the DAB mother code,
+//	rate 1/4, K = 7), QPSK modulated and passed through AWGN, then
+//	decoded from
+//	- the old int16_t soft bits, the int8_t ones should give
+//	  exactly the same errors;
+//	- int16_t soft bits with a finer scale (-1024 .. 1024, as for
+//	  the FIC), the int8_t ones should not be worse, beyond sampling
+//	  noise.
+#include	<assert.h>
+#include	<random>
+#include	<vector>
+#include	"dab-constants.h"
+#include	"viterbi-handler.h"
+
+#define	BLOCK_LENGTH	768
+#define	NR_BLOCKS	300
+
+static const int polynomes [4] = {0133, 0171, 0145, 0133};
+
+static
+uint8_t	parity	(int v) {
+uint8_t	p	= 0;
+	while (v != 0) {
+	   p ^= v & 01;
+	   v >>= 1;
+	}
+	return p;
+}
+//
+//	the new bit enters the register at the top, as in the decoder,
+//	the block is followed by 6 zero bits to flush the register
+static
+void	encode	(const std::vector<uint8_t> &in, std::vector<uint8_t> &out) {
+int	state	= 0;
+
+	out. resize (4 * (in. size () + 6));
+	for (uint32_t i = 0; i < in. size () + 6; i ++) {
+	   int bit	= i < in. size () ? in [i] : 0;
+	   int reg	= (bit << 6) | state;
+	   for (int j = 0; j < 4; j ++)
+	      out [4 * i + j] = parity (reg & polynomes [j]);
+	   state	= reg >> 1;
+	}
+}
+
+static
+int	errors	(const std::vector<uint8_t> &a, const uint8_t *b) {
+int	n	= 0;
+	for (uint32_t i = 0; i < a. size (); i ++)
+	   if (a [i] != b [i])
+	      n ++;
+	return n;
+}
+//
+//	returns the bit error rates for the old, the fine and the int8_t
+//	soft bits, sigma is the standard deviation of the noise per
+//	dimension
+static
+void	run	(float sigma, double *berOld, double *berFine, double *ber8) {
+std::mt19937	gen (4711);
+std::normal_distribution<float> noise (0.0, sigma);
+viterbiHandler	viterbi (BLOCK_LENGTH);
+std::vector<uint8_t>	data (BLOCK_LENGTH);
+std::vector<uint8_t>	coded;
+std::vector<int16_t>	softOld;
+std::vector<int16_t>	softFine;
+std::vector<int8_t>	soft8;
+uint8_t		decoded [BLOCK_LENGTH];
+int	errorsOld	= 0;
+int	errorsFine	= 0;
+int	errors8		= 0;
+
+	for (int n = 0; n < NR_BLOCKS; n ++) {
+	   for (auto &b : data)
+	      b = gen () & 01;
+	   encode (data, coded);
+	   softOld. resize (coded. size ());
+	   softFine. resize (coded. size ());
+	   soft8. resize (coded. size ());
+	   for (uint32_t i = 0; i < coded. size (); i += 2) {
+	      std::complex<float> r ((1 - 2 * coded [i])     / sqrt (2.0),
+	                             (1 - 2 * coded [i + 1]) / sqrt (2.0));
+	      r	+= std::complex<float> (noise (gen), noise (gen));
+	      float ab	= jan_abs (r);
+	      softOld [i]	= - real (r) / ab * 127.0;
+	      softOld [i + 1]	= - imag (r) / ab * 127.0;
+	      softFine [i]	= - real (r) / ab * 1024.0;
+	      softFine [i + 1]	= - imag (r) / ab * 1024.0;
+	      soft8 [i]		= softBit (- real (r), ab);
+	      soft8 [i + 1]	= softBit (- imag (r), ab);
+	      assert ((soft8 [i] > -128) && (soft8 [i + 1] > -128));
+	   }
+	   viterbi. deconvolve (softOld. data (), decoded);
+	   errorsOld	+= errors (data, decoded);
+	   viterbi. deconvolve (softFine. data (), decoded);
+	   errorsFine	+= errors (data, decoded);
+	   viterbi. deconvolve (soft8. data (), decoded);
+	   errors8	+= errors (data, decoded);
+	}
+	*berOld		= (double)errorsOld  / (NR_BLOCKS * BLOCK_LENGTH);
+	*berFine	= (double)errorsFine / (NR_BLOCKS * BLOCK_LENGTH);
+	*ber8		= (double)errors8    / (NR_BLOCKS * BLOCK_LENGTH);
+}
+
+int	main	(void) {
+double	berOld, berFine, ber8;
+const float ebn0s [] = {2.0, 3.0, 4.0};
+
+//	softBit: saturation and erasures
+	assert (softBit (1.0, 0.0) == 0);
+	assert (softBit (5.0, 1.0) == 127);
+	assert (softBit (-5.0, 1.0) == -127);
+	assert (softBit (-1.0, 1.0) == -127);
+//
+//	without noise, both decode without errors
+	run (0.0, &berOld, &berFine, &ber8);
+	assert ((berOld == 0) && (berFine == 0) && (ber8 == 0));
+//
+//	Eb/N0 with 2 bits per symbol and rate 1/4: sigma^2 = 1 / (Eb/N0)
+	for (float ebn0 : ebn0s) {
+	   float sigma	= sqrt (1.0 / pow (10.0, ebn0 / 10.0));
+	   run (sigma, &berOld, &berFine, &ber8);
+	   fprintf (stderr,
+	            "Eb/N0 %4.1f dB: ber old %.2e, fine %.2e, int8 %.2e\n",
+	                                 ebn0, berOld, berFine, ber8);
+	   assert (berFine > 0);
+	   assert (ber8 == berOld);
+	   assert (ber8 <= 1.1 * berFine + 2e-4);
+	}
+	fprintf (stderr, "softbit-test passed\n");
+	return 0;
+}
+